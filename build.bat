@@ -6,16 +6,17 @@ REM Define compiler and flags
 SET CC=gcc
 SET CFLAGS=-Wall -Wextra -g
 SET INCLUDES=-Iinclude
+SET LIBS=-lpthread
 
 REM Define the target executable name
 SET TARGET=bin\regex_engine.exe
 
 REM Find all source files in the project
-SET SOURCES=main.c src\parser.c src\nfa.c src\simulator.c src\dfa.c
+SET SOURCES=main.c src\parser.c src\nfa.c src\simulator.c src\dfa.c src\shift_and.c src\regex_ast.c src\mapped_file.c src\lexer.c src\grep.c src\trigram.c src\aho_corasick.c src\planner.c
 
 REM --- Compilation Step ---
 echo Compiling project...
-%CC% %CFLAGS% %SOURCES% -o %TARGET% %INCLUDES%
+%CC% %CFLAGS% %SOURCES% -o %TARGET% %INCLUDES% %LIBS%
 
 REM --- Check if compilation was successful and run ---
 if %errorlevel% neq 0 (
@@ -0,0 +1,77 @@
+#ifndef AHO_CORASICK_H
+#define AHO_CORASICK_H
+
+#include <stddef.h>
+
+/**
+ * @struct AhoCorasick
+ * @brief A keyword trie with failure links, for pure literal alternations
+ * such as "word1|word2|...|word5000".
+ *
+ * Node 0 is the root. The children of a node form a linked list sorted by
+ * byte; the root also has a dense table, since nearly every scan step
+ * passes through it. Building takes time linear in the total keyword
+ * length, and scanning is linear in the input no matter how many keywords
+ * there are.
+ */
+typedef struct AhoCorasick {
+    int num_nodes;
+    int num_words;
+    unsigned char* byte;    // Label of the edge into each node
+    int* first_child;       // First child of each node (-1 if none)
+    int* next_sibling;      // Next child of the same parent (-1 if none)
+    int* depth;             // Length of the path from the root
+    int* fail;              // Node for the longest proper suffix that is also in the trie
+    int* match_length;      // Longest keyword ending at this node (0 if none)
+    int root_next[256];     // The root's child for each byte (0 if none)
+} AhoCorasick;
+
+/**
+ * @brief Checks whether a regex is nothing but literal alternatives.
+ * Alternatives may use escapes and one-character classes ("a\.b|[x]y"),
+ * but no grouping, stars or multi-character classes.
+ * @param regex The infix regex, as typed by the user.
+ * @return The total number of literal characters, or -1 if the regex is not
+ *         a pure literal alternation.
+ */
+int literal_alternation_size(const char* regex);
+
+/**
+ * @brief Builds the Aho-Corasick automaton straight from the infix regex,
+ * without going through preprocessing, postfix or an NFA.
+ * @param regex A regex for which literal_alternation_size() is positive.
+ * @return A pointer to the automaton, or NULL on failure.
+ */
+AhoCorasick* build_aho_corasick(const char* regex);
+
+/**
+ * @brief Checks whether the whole string is one of the keywords.
+ * @return 1 (true) if it is, 0 (false) otherwise.
+ */
+int simulate_aho_corasick(AhoCorasick* ac, const char* str);
+
+/**
+ * @brief Finds the leftmost-longest keyword occurrence in a string in one
+ * pass, the same match search_dfa() reports. The scan stops as soon as no
+ * later keyword could start at or before the best match.
+ * @param match_start Receives the index of the first matched character.
+ * @param match_end Receives the index one past the last matched character.
+ * @return 1 if a keyword was found, 0 otherwise.
+ */
+int search_aho_corasick(AhoCorasick* ac, const char* str, int* match_start, int* match_end);
+
+/**
+ * @brief Checks whether any keyword occurs in a buffer, stopping at the
+ * first one. Only reads the automaton, so threads can share it.
+ * @param text The buffer to scan (need not be null-terminated).
+ * @param length The number of bytes to scan.
+ * @return 1 if some keyword occurs in the buffer, 0 otherwise.
+ */
+int aho_corasick_has_match(const AhoCorasick* ac, const char* text, size_t length);
+
+/**
+ * @brief Frees all memory associated with the automaton.
+ */
+void free_aho_corasick(AhoCorasick* ac);
+
+#endif // AHO_CORASICK_H
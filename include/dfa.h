@@ -2,10 +2,33 @@
 #define DFA_H
 
 #include "nfa.h" // We need this for the 'State' struct
+#include <stddef.h>
 
-// Arbitrary limits for our simple converter
+// Default state budget for nfa_to_dfa() and nfa_to_search_dfa(). Subset
+// construction can blow up exponentially, so every build stops (and fails
+// cleanly) once its budget is used up.
 #define MAX_DFA_STATES 256
-#define MAX_NFA_STATES_PER_DFA_STATE 1024 // Should match simulator's limit
+
+// Most states a product construction may create. A product of A and B can
+// need up to |A| * (|B| + 1) states, so the limit is sized from the operands
+// and only capped here, well above the product of two default-budget DFAs.
+#define MAX_PRODUCT_DFA_STATES (1 << 17)
+
+/**
+ * @struct DfaBudget
+ * @brief Limits for one subset construction.
+ */
+typedef struct DfaBudget {
+    int max_states;     // Most DFA states to create
+    size_t max_bytes;   // Most memory for states and their NFA sets (0 for no limit)
+} DfaBudget;
+
+// Which budget limit stopped a subset construction
+typedef enum DfaLimit {
+    DFA_WITHIN_BUDGET,  // The build did not run out of budget
+    DFA_STATE_LIMIT,    // One more state would pass max_states
+    DFA_BYTE_LIMIT      // One more state would pass max_bytes
+} DfaLimit;
 
 /**
  * @struct DfaState
@@ -18,10 +41,12 @@
 typedef struct DfaState {
     int id;
     int is_accepting; // 1 if this state is an accepting state, 0 otherwise
+    int accept_id;    // Lowest accept_id of its accepting NFA states (-1 if none)
 
-    // The set of NFA states this DFA state represents
-    State* nfa_states[MAX_NFA_STATES_PER_DFA_STATE];
+    // The set of NFA states this DFA state represents (sorted by ID)
+    State** nfa_states;
     int num_nfa_states;
+    unsigned int set_hash; // Hash of the set, checked before comparing sets
 
     // Transition table: one entry for every possible ASCII character.
     // Index by (int)c. A NULL entry means a transition to a "dead state".
@@ -37,8 +62,10 @@ typedef struct DfaState {
  */
 typedef struct Dfa {
     DfaState* start_state;
-    DfaState* all_states[MAX_DFA_STATES];
+    DfaState** all_states;
     int num_states;
+    int max_states;     // Allocated capacity of 'all_states'
+    size_t num_bytes;   // Memory used by the states and their NFA sets
 } Dfa;
 
 /**
@@ -48,6 +75,50 @@ typedef struct Dfa {
  */
 Dfa* nfa_to_dfa(Nfa* nfa);
 
+/**
+ * @brief Converts an NFA into an unanchored DFA for searching.
+ * The DFA can start a match at any position of the input, so it reaches
+ * an accepting state as soon as any match ends.
+ * @param nfa The NFA to convert (uses nfa->start).
+ * @return A pointer to the newly created Dfa, or NULL on failure.
+ */
+Dfa* nfa_to_search_dfa(Nfa* nfa);
+
+/**
+ * @brief Runs subset construction under a budget.
+ * Unlike nfa_to_dfa(), running out of budget is an expected outcome here
+ * and prints nothing, so a caller can fall back to simulating the NFA.
+ * @param nfa The NFA to convert (uses nfa->start).
+ * @param unanchored 1 for a search DFA (see nfa_to_search_dfa()), 0 otherwise.
+ * @param budget The state and memory limits.
+ * @param over_budget Receives the limit that stopped the build, or
+ *                    DFA_WITHIN_BUDGET if it succeeded or failed otherwise.
+ * @return A pointer to the newly created Dfa, or NULL on failure.
+ */
+Dfa* nfa_to_dfa_within_budget(Nfa* nfa, int unanchored, const DfaBudget* budget, DfaLimit* over_budget);
+
+/**
+ * @brief Builds a DFA accepting the strings accepted by both a and b.
+ * Uses the product construction, so one pass over the input evaluates
+ * "matches A and B". States that can never accept are pruned.
+ * @return A pointer to the new Dfa, or NULL on failure (e.g., too many states).
+ */
+Dfa* dfa_intersect(Dfa* a, Dfa* b);
+
+/**
+ * @brief Builds a DFA accepting the strings accepted by a but not by b
+ * ("matches A and not B"), using the product construction.
+ * @return A pointer to the new Dfa, or NULL on failure (e.g., too many states).
+ */
+Dfa* dfa_difference(Dfa* a, Dfa* b);
+
+/**
+ * @brief Builds a DFA accepting every string the given DFA rejects.
+ * The complement is taken over all non-NUL bytes.
+ * @return A pointer to the new Dfa, or NULL on failure.
+ */
+Dfa* dfa_complement(Dfa* dfa);
+
 /**
  * @brief Simulates a DFA against a given string.
  * This is much faster than the NFA simulation.
@@ -57,6 +128,30 @@ Dfa* nfa_to_dfa(Nfa* nfa);
  */
 int simulate_dfa(Dfa* dfa, const char* str);
 
+/**
+ * @brief Finds the leftmost-longest match inside a string in two linear
+ * DFA passes. A backward pass over the whole string finds the leftmost
+ * position where a match starts, then a forward pass from there finds the
+ * longest match starting at it.
+ * @param forward The anchored DFA from nfa_to_dfa().
+ * @param reverse The unanchored DFA of the reversed NFA (see reverse_nfa()
+ *                and nfa_to_search_dfa()).
+ * @param str The input string.
+ * @param match_start Receives the index of the first matched character.
+ * @param match_end Receives the index one past the last matched character.
+ * @return 1 if a match was found, 0 otherwise.
+ */
+int search_dfa(Dfa* forward, Dfa* reverse, const char* str, int* match_start, int* match_end);
+
+/**
+ * @brief Checks whether a match occurs anywhere in a buffer (one forward pass).
+ * @param forward The unanchored DFA from nfa_to_search_dfa().
+ * @param text The buffer to scan (need not be null-terminated).
+ * @param length The number of bytes to scan.
+ * @return 1 if some match ends inside the buffer, 0 otherwise.
+ */
+int dfa_has_match(Dfa* forward, const char* text, size_t length);
+
 /**
  * @brief Frees all memory associated with a DFA.
  * @param dfa The DFA to free.
@@ -0,0 +1,38 @@
+#ifndef GREP_H
+#define GREP_H
+
+#include <stdio.h>
+#include "planner.h"
+
+/**
+ * @struct GrepOptions
+ * @brief Tuning knobs for grep_paths(). Zero fields pick the defaults.
+ */
+typedef struct GrepOptions {
+    int num_threads;      // Matcher threads (0 = one per online CPU)
+    size_t chunk_size;    // Files larger than this are split into chunks of about this size
+    int max_pending;      // Chunks the reader may have in flight before it blocks
+} GrepOptions;
+
+/**
+ * @brief Prints every line, in every given file, that contains a match.
+ *
+ * Directories are searched recursively, in sorted order. The work runs as
+ * a pipeline: one reader thread maps files and cuts them into chunks at
+ * line boundaries, a pool of matcher threads scans the chunks (each thread
+ * owns a deque of chunks and steals from the others when it runs dry), and
+ * the calling thread writes the results. All matchers share the same
+ * engine plan, which is only read. Output is "path:line:text", in exactly the order a
+ * sequential scan would produce it.
+ *
+ * @param plan A PLAN_SEARCH plan from plan_engine() (a DFA, or the NFA if over budget).
+ * @param paths The files and directories to search.
+ * @param num_paths The number of entries in 'paths'.
+ * @param options Tuning options, or NULL for the defaults.
+ * @param out Where to write the matching lines.
+ * @return The number of matching lines, or -1 on failure.
+ */
+long grep_paths(const EnginePlan* plan, char* const* paths, int num_paths,
+                const GrepOptions* options, FILE* out);
+
+#endif // GREP_H
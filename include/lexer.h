@@ -0,0 +1,72 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include "tokens.h"
+#include "dfa.h"
+#include "mapped_file.h"
+
+/**
+ * @struct Lexer
+ * @brief Tokenizes one source buffer with a shared token DFA.
+ *
+ * The buffer is either supplied by the caller or a memory-mapped file;
+ * in both cases tokens point into it and nothing is copied.
+ */
+typedef struct Lexer {
+    const char* source; // The text being tokenized (not null-terminated)
+    size_t length;      // Size of 'source' in bytes
+    size_t position;    // Offset of the next unread byte
+    int line;           // Current 1-based line number
+    Dfa* dfa;           // Token DFA from build_lexer_dfa() (not owned)
+    MappedFile file;    // The mapping, if the source came from lexer_open_file()
+} Lexer;
+
+/**
+ * @brief Compiles the whole token table into a single DFA.
+ * Each accepting state carries the index of the highest-priority token
+ * rule it accepts (its accept_id), so one DFA run recognises every token
+ * kind, including the whitespace and comments that get skipped.
+ * @return A pointer to the token Dfa, or NULL on failure.
+ */
+Dfa* build_lexer_dfa(void);
+
+/**
+ * @brief Prepares a lexer over a caller-owned buffer.
+ * @param lexer The lexer to initialize.
+ * @param dfa The token DFA from build_lexer_dfa().
+ * @param source The text to tokenize (must outlive the lexer).
+ * @param length The size of the text in bytes.
+ */
+void lexer_init(Lexer* lexer, Dfa* dfa, const char* source, size_t length);
+
+/**
+ * @brief Prepares a lexer over a memory-mapped file.
+ * @param lexer The lexer to initialize.
+ * @param dfa The token DFA from build_lexer_dfa().
+ * @param path The file to tokenize.
+ * @return 0 on success, -1 if the file cannot be mapped.
+ */
+int lexer_open_file(Lexer* lexer, Dfa* dfa, const char* path);
+
+/**
+ * @brief Returns the next token using maximal munch (longest match).
+ * Ties between rules of equal length go to the rule listed first.
+ * Whitespace and comments are skipped; at the end of the input a
+ * TOKEN_EOF is returned (repeatedly).
+ * @param lexer The lexer to read from.
+ * @return The next token, as a view into the source buffer.
+ */
+Token get_next_token(Lexer* lexer);
+
+/**
+ * @brief Returns a printable name for a token type, e.g. "TOKEN_ID".
+ */
+const char* token_type_name(TokenType type);
+
+/**
+ * @brief Releases the lexer's file mapping, if any. The DFA is not freed.
+ * @param lexer The lexer to close.
+ */
+void lexer_close(Lexer* lexer);
+
+#endif // LEXER_H
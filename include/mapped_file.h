@@ -0,0 +1,60 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+
+#ifdef _WIN32
+#define PATH_SEPARATOR '\\'
+#else
+#define PATH_SEPARATOR '/'
+#endif
+
+/**
+ * @struct MappedFile
+ * @brief A read-only view of a whole file mapped into memory.
+ *
+ * Scanning a mapped file reads straight from the page cache: no read()
+ * copies and no per-file buffers. The data is NOT null-terminated, so
+ * always scan with 'length'.
+ */
+typedef struct MappedFile {
+    const char* data;   // First byte of the file (an empty string for empty files)
+    size_t length;      // File size in bytes
+    void* handle;       // Platform mapping handle (NULL if nothing is mapped)
+} MappedFile;
+
+/**
+ * @brief Maps a file read-only into memory.
+ * @param path The path of the file to map.
+ * @param file Receives the mapping.
+ * @return 0 on success, -1 on failure (e.g., the file cannot be opened).
+ */
+int map_file(const char* path, MappedFile* file);
+
+/**
+ * @brief Releases a mapping created by map_file().
+ * @param file The mapping to release (safe to call on an empty mapping).
+ */
+void unmap_file(MappedFile* file);
+
+/**
+ * @brief Returns 1 if the path names a directory, 0 otherwise.
+ */
+int is_directory(const char* path);
+
+/**
+ * @brief Lists a directory's entries (without "." and ".."), sorted by name.
+ * @param path The directory to list.
+ * @param names Receives a malloc'd array of malloc'd names (free each, then the array).
+ * @param count Receives the number of names.
+ * @return 0 on success, -1 if the directory cannot be read.
+ */
+int list_directory(const char* path, char*** names, int* count);
+
+/**
+ * @brief Joins a directory and an entry name with the platform separator.
+ * @return A malloc'd path, or NULL on allocation failure.
+ */
+char* join_path(const char* directory, const char* name);
+
+#endif // MAPPED_FILE_H
@@ -1,15 +1,17 @@
 #ifndef NFA_H
 #define NFA_H
 
-// A single state in NFA. It can have up to two transitions.
-// According to Thompsons constructions
-// a state has at most two epsilon-transitions.
-// Regular transitions are handled by creating a new state pair.
+// A single state in NFA.
+// According to Thompsons constructions a state has at most two
+// transitions, but the Glushkov builder gives a state one transition per
+// position that may follow it, so the transition list grows on demand.
 typedef struct State {
     int id;
-    struct Transition* transitions[2];
+    struct Transition** transitions;
     int num_transitions;
+    int max_transitions;    // Allocated capacity of 'transitions'
     int is_accepting;
+    int accept_id;          // Which pattern an accepting state belongs to (-1 if untagged)
 } State;
 
 // A transition represents a directed edge from one state to another.
@@ -20,12 +22,23 @@ typedef struct Transition {
 
 // Represents an NFA fragment with a start and end state.
 // This is the fundamental unit used in Thompson's Construction.
+// A Glushkov NFA may have several accepting states, so its 'end' is NULL.
 typedef struct Nfa {
     State* start;
     State* end;
+    int is_epsilon_free;    // 1 if no transition is an epsilon (no closure needed)
 } Nfa;
 
 
+// Size figures the engine planner uses to estimate automaton cost.
+typedef struct NfaStats {
+    int num_states;
+    int num_positions;      // States with at least one character transition
+    int min_id;             // State IDs of one NFA lie in [min_id, max_id]
+    int max_id;
+} NfaStats;
+
+
 /**
  * @brief Builds a complete NFA from a postfix regular expression.
  * @param postfix The postfix regex string.
@@ -33,9 +46,51 @@ typedef struct Nfa {
  */
 Nfa* build_nfa_from_postfix(const char* postfix);
 
+/**
+ * @brief Builds an epsilon-free NFA from a postfix regular expression
+ * using Glushkov's (position automaton) construction.
+ * The result has exactly one state per literal plus one start state, and
+ * every transition consumes a character, so simulation and subset
+ * construction need no epsilon-closure.
+ * @param postfix The postfix regex string.
+ * @return A pointer to the final Nfa (with end == NULL), or NULL on failure.
+ */
+Nfa* build_glushkov_nfa_from_postfix(const char* postfix);
+
+/**
+ * @brief Builds the reverse of an NFA by flipping every transition.
+ * The result accepts a string exactly when the original accepts it reversed,
+ * which lets a backward scan find where a match starts.
+ * @param nfa The NFA to reverse (left untouched).
+ * @return A pointer to the new reversed Nfa, or NULL on failure.
+ */
+Nfa* reverse_nfa(Nfa* nfa);
+
+/**
+ * @brief Joins several NFAs into one with a new start state that has an
+ * epsilon-transition to each of them, like an n-way union that keeps the
+ * alternatives apart: every accepting state of nfas[i] gets accept_id = i.
+ * This is how a lexer compiles its whole token table into one automaton.
+ * @param nfas The NFAs to join; their Nfa structs are freed, their states
+ *             become part of the result.
+ * @param count The number of NFAs.
+ * @return A pointer to the combined Nfa (with end == NULL), or NULL on failure.
+ */
+Nfa* build_tagged_union_nfa(Nfa** nfas, int count);
+
+/**
+ * @brief Counts the states and positions of an NFA.
+ * Simulators size their state sets from this, and the planner uses the
+ * number of positions to estimate how large a DFA would get.
+ * @param nfa The NFA to measure.
+ * @param stats Receives the figures.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int measure_nfa(Nfa* nfa, NfaStats* stats);
+
 /**
  * @brief Frees all memory associated with an NFA.
- * (Important for preventing memory leaks - we will implement this later)
+ * Walks the state graph from nfa->start and frees every state and transition.
  * @param nfa The NFA to free.
  */
 void free_nfa(Nfa* nfa);
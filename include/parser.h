@@ -6,7 +6,7 @@
  * This makes parsing unambiguous. e.g., "ab" -> "a.b", "(a|b)c" -> "(a|b).c"
  * @param regex The input regular expression string.
  * @param outputBuffer The buffer to store the pre-processed string.
- * @param bufferSize The size of the output buffer.
+ * @param bufferSize The size of the output buffer (2 * strlen(regex) + 1 always suffices).
  */
 void preprocess_regex(const char* regex, char* outputBuffer, int bufferSize);
 
@@ -15,9 +15,28 @@ void preprocess_regex(const char* regex, char* outputBuffer, int bufferSize);
  * This uses the Shunting-Yard algorithm.
  * @param infix The pre-processed infix regex string.
  * @param postfix The buffer to store the resulting postfix string.
- * @param bufferSize The size of the postfix buffer.
+ * @param bufferSize The size of the postfix buffer (strlen(infix) + 1 always suffices).
  * @return 0 on success, -1 on failure (e.g., buffer too small).
  */
 int regex_to_postfix(const char* infix, char* postfix, int bufferSize);
 
+/**
+ * @brief Measures the operand that starts at the given position.
+ * Operands are an alphanumeric character, an escape ("\*", "\n", "\t",
+ * "\r", or a backslash before any other character for that character), or
+ * a bracket class such as "[a-z_]" or "[^\n]". Operands appear unchanged
+ * in both the infix and postfix forms, so every builder uses this helper.
+ * @param regex Pointer into an infix or postfix regex string.
+ * @return The operand's length in characters, or 0 if no operand starts here.
+ */
+int regex_operand_length(const char* regex);
+
+/**
+ * @brief Decodes the operand at the given position into the bytes it matches.
+ * @param operand Pointer to an operand (see regex_operand_length()).
+ * @param set Receives set[c] = 1 for every byte c the operand matches.
+ * @return The operand's length in characters, or 0 if no operand starts here.
+ */
+int regex_operand_chars(const char* operand, unsigned char set[256]);
+
 #endif // PARSER_H
\ No newline at end of file
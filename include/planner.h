@@ -0,0 +1,124 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <stddef.h>
+#include "nfa.h"
+#include "dfa.h"
+#include "shift_and.h"
+#include "aho_corasick.h"
+#include "simulator.h"
+
+// Default budget for the DFAs the planner builds. Subset construction can
+// blow up exponentially, so past this the NFA is simulated instead.
+#define PLANNER_MAX_DFA_STATES 4096
+#define PLANNER_MAX_DFA_BYTES ((size_t)64 << 20)
+
+// What a plan is used for
+typedef enum PlanMode {
+    PLAN_FULL_MATCH,    // Does the whole string match? (plan_match)
+    PLAN_SEARCH,        // Does a match occur anywhere in a buffer? (plan_has_match)
+    PLAN_SPAN           // Where is the leftmost-longest match? (plan_search, plan_has_match)
+} PlanMode;
+
+// The engines a plan can pick, from cheapest to build to slowest to run
+typedef enum EngineKind {
+    ENGINE_SHIFT_AND,       // Bit-parallel NFA, full match only
+    ENGINE_AHO_CORASICK,    // Keyword trie, pure literal alternations only
+    ENGINE_DFA,             // Subset-constructed DFA (two for PLAN_SPAN)
+    ENGINE_NFA              // Direct NFA simulation, always available
+} EngineKind;
+
+/**
+ * @struct EnginePlan
+ * @brief The engine chosen for one pattern, the reason for the choice, and
+ * the automata that engine runs on.
+ *
+ * Planning never fails just because a pattern is large: a DFA is only built
+ * when the NFA suggests it will fit the budget, and a build that runs out of
+ * budget anyway falls back to simulating the NFA.
+ */
+typedef struct EnginePlan {
+    PlanMode mode;
+    EngineKind engine;
+    char reason[160];           // Why this engine was chosen, for logs
+    NfaStats stats;             // Size of the NFA the plan was made from
+    int estimated_dfa_states;   // Expected DFA size: one state per position, plus a start state
+
+    Nfa* nfa;                   // The caller's NFA (not owned; must outlive the plan)
+    Nfa* reversed;              // PLAN_SPAN: the reversal of 'nfa' (owned)
+    Dfa* dfa;                   // ENGINE_DFA: unanchored for PLAN_SEARCH, anchored otherwise (owned)
+    Dfa* reverse_dfa;           // ENGINE_DFA with PLAN_SPAN: unanchored (owned)
+    ShiftAndNfa* shift_and;     // ENGINE_SHIFT_AND (owned)
+    AhoCorasick* aho_corasick;  // ENGINE_AHO_CORASICK (owned)
+    NfaRun* run;                // ENGINE_NFA: working memory for plan_match() and plan_search() (owned)
+    NfaRun* reverse_run;        // ENGINE_NFA with PLAN_SPAN: the same for 'reversed' (owned)
+} EnginePlan;
+
+/**
+ * @brief Picks the fastest engine for a pattern that fits the budget.
+ * Full matches use the bit-parallel engine when the pattern fits a machine
+ * word, and keyword lists too long for it use Aho-Corasick. Otherwise the planner estimates the DFA size from the NFA's
+ * positions and, if the estimate fits, builds the DFA under the budget.
+ * When the estimate or the build is over budget, the NFA is simulated.
+ * @param nfa The pattern's NFA (Thompson or Glushkov); the plan keeps a pointer to it.
+ * @param regex The pattern as typed, for the Aho-Corasick engine (may be NULL).
+ * @param postfix The pattern's postfix form, for the bit-parallel engine (may be NULL).
+ * @param mode What the plan will be used for.
+ * @param budget The DFA limits, or NULL for the defaults above.
+ * @return A pointer to the plan, or NULL if even the NFA fallback cannot be set up.
+ */
+EnginePlan* plan_engine(Nfa* nfa, const char* regex, const char* postfix, PlanMode mode,
+                        const DfaBudget* budget);
+
+/**
+ * @brief Checks whether the whole string matches (PLAN_FULL_MATCH and
+ * PLAN_SPAN plans). Uses the plan's own NFA run, so only one thread may
+ * call it at a time.
+ * @return 1 (true) if the string is accepted, 0 (false) otherwise,
+ *         and always 0 for PLAN_SEARCH plans.
+ */
+int plan_match(const EnginePlan* plan, const char* str);
+
+/**
+ * @brief Checks whether plan_has_match() simulates the NFA for this plan,
+ * and so needs a run from create_plan_run().
+ * @return 1 if a run is needed, 0 otherwise.
+ */
+int plan_needs_run(const EnginePlan* plan);
+
+/**
+ * @brief Allocates the working memory one thread needs for plan_has_match().
+ * @return A run for plans whose search simulates the NFA; NULL for plans
+ *         that need none, or if the allocation failed.
+ */
+NfaRun* create_plan_run(const EnginePlan* plan);
+
+/**
+ * @brief Checks whether a match occurs anywhere in a buffer
+ * (PLAN_SEARCH and PLAN_SPAN plans). Safe to call from several threads,
+ * as long as each passes its own run.
+ * @param run The caller's run from create_plan_run(); required whenever
+ *            that returns one, since no run is allocated per call.
+ * @return 1 if some match ends inside the buffer, 0 otherwise,
+ *         and always 0 for PLAN_FULL_MATCH plans.
+ */
+int plan_has_match(const EnginePlan* plan, NfaRun* run, const char* text, size_t length);
+
+/**
+ * @brief Finds the leftmost-longest match in a string, like search_dfa()
+ * (PLAN_SPAN plans). Like plan_match(), one thread at a time.
+ * @return 1 if a match was found, 0 otherwise.
+ */
+int plan_search(const EnginePlan* plan, const char* str, int* match_start, int* match_end);
+
+/**
+ * @brief Returns a short display name for an engine, e.g. "DFA".
+ */
+const char* engine_name(EngineKind engine);
+
+/**
+ * @brief Frees a plan and the automata it owns (not the caller's NFA).
+ */
+void free_engine_plan(EnginePlan* plan);
+
+#endif // PLANNER_H
@@ -0,0 +1,68 @@
+#ifndef REGEX_AST_H
+#define REGEX_AST_H
+
+// The kinds of node in a regex syntax tree
+typedef enum RegexNodeType {
+    REGEX_LITERAL,  // A run of one or more literal characters, e.g. "abc"
+    REGEX_CLASS,    // A bracket class such as "[a-z]", kept as written
+    REGEX_CONCAT,   // Children matched one after another (n-ary)
+    REGEX_UNION,    // Any one of the children (n-ary)
+    REGEX_STAR      // Zero or more repetitions of the single child
+} RegexNodeType;
+
+/**
+ * @struct RegexNode
+ * @brief A node of the regex abstract syntax tree.
+ *
+ * The tree sits between regex_to_postfix() and the automaton builders so
+ * that redundant structure can be rewritten away before it turns into
+ * redundant states. Concatenation and union are n-ary so that nested
+ * chains like ((a|b)|c) flatten into a single node.
+ */
+typedef struct RegexNode {
+    RegexNodeType type;
+
+    // REGEX_LITERAL: the characters; REGEX_CLASS: the class source text.
+    // Not null-terminated; text_length is the count.
+    char* text;
+    int text_length;
+
+    // REGEX_CONCAT / REGEX_UNION: the operands; REGEX_STAR: exactly one
+    struct RegexNode** children;
+    int num_children;
+} RegexNode;
+
+/**
+ * @brief Builds a syntax tree from a postfix regular expression.
+ * @param postfix The postfix regex string.
+ * @return The root node, or NULL on failure (e.g., malformed postfix).
+ */
+RegexNode* build_ast_from_postfix(const char* postfix);
+
+/**
+ * @brief Rewrites a syntax tree into a smaller equivalent one.
+ * Applies, bottom-up: flattening of nested concatenations/unions,
+ * literal-string merging, star flattening ((a*)* -> a*, (a*|b)* -> (a|b)*,
+ * (a*b*)* -> (a|b)*), duplicate-alternative removal, and prefix/suffix
+ * factoring of alternations (abc|abd -> ab(c|d), xz|yz -> (x|y)z).
+ * @param node The root node; ownership passes to the function.
+ * @return The root of the optimized tree (the input must not be used again).
+ */
+RegexNode* optimize_ast(RegexNode* node);
+
+/**
+ * @brief Converts a syntax tree back to a postfix regular expression.
+ * @param node The root node.
+ * @param postfix The buffer to store the resulting postfix string.
+ * @param bufferSize The size of the postfix buffer.
+ * @return 0 on success, -1 on failure (e.g., buffer too small).
+ */
+int ast_to_postfix(RegexNode* node, char* postfix, int bufferSize);
+
+/**
+ * @brief Frees a syntax tree and all of its nodes.
+ * @param node The root node to free.
+ */
+void free_ast(RegexNode* node);
+
+#endif // REGEX_AST_H
@@ -0,0 +1,64 @@
+#ifndef SHIFT_AND_H
+#define SHIFT_AND_H
+
+#include <stdint.h>
+
+// Every character position of the pattern gets one bit of a machine word
+#define SHIFT_AND_MAX_POSITIONS 64
+// The follow table is indexed one byte of the state mask at a time
+#define SHIFT_AND_CHUNKS (SHIFT_AND_MAX_POSITIONS / 8)
+
+/**
+ * @struct ShiftAndNfa
+ * @brief A bit-parallel (Glushkov) NFA for patterns with at most 64 positions.
+ *
+ * Each literal in the pattern is a "position" and owns one bit of a 64-bit
+ * mask. The set of active NFA states is a single uint64_t, so one input
+ * character is processed with a handful of table lookups, ANDs and ORs,
+ * with no epsilon-closure and no subset construction.
+ */
+typedef struct ShiftAndNfa {
+    int num_positions;
+    int nullable;            // 1 if the pattern accepts the empty string
+
+    uint64_t first;          // Positions that can match the first character
+    uint64_t last;           // Positions that can match the final character
+
+    // char_masks[c]: the positions labelled with character c
+    uint64_t char_masks[256];
+
+    // follow_tables[k][b]: union of the follow sets of the positions whose
+    // bits are set in byte b of the state mask, for byte number k
+    uint64_t follow_tables[SHIFT_AND_CHUNKS][256];
+} ShiftAndNfa;
+
+/**
+ * @brief Checks whether a pattern is small enough for the bit-parallel engine.
+ * @param postfix The postfix regex string.
+ * @return 1 if it has at most SHIFT_AND_MAX_POSITIONS positions, 0 otherwise.
+ */
+int shift_and_fits(const char* postfix);
+
+/**
+ * @brief Builds a bit-parallel NFA from a postfix regular expression.
+ * @param postfix The postfix regex string.
+ * @return A pointer to the new ShiftAndNfa, or NULL if it does not fit or is malformed.
+ */
+ShiftAndNfa* build_shift_and(const char* postfix);
+
+/**
+ * @brief Simulates the bit-parallel NFA against a given string.
+ * Runs in linear time: a few word operations per input character.
+ * @param sa The ShiftAndNfa to simulate.
+ * @param str The input string.
+ * @return 1 (true) if the string is accepted, 0 (false) otherwise.
+ */
+int simulate_shift_and(ShiftAndNfa* sa, const char* str);
+
+/**
+ * @brief Frees a ShiftAndNfa.
+ * @param sa The ShiftAndNfa to free.
+ */
+void free_shift_and(ShiftAndNfa* sa);
+
+#endif // SHIFT_AND_H
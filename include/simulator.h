@@ -1,17 +1,79 @@
 #ifndef SIMULATOR_H
 #define SIMULATOR_H
 
+#include <stddef.h>
 #include "nfa.h"
 
+/**
+ * @brief Working memory for simulating one NFA (see simulator.c)
+ *
+ * Allocating the state sets is most of the cost of a short simulation, so
+ * callers that run the same NFA over many lines keep one run and pass it
+ * in. A run may be reused any number of times, but by one thread at a time.
+ */
+typedef struct NfaRun NfaRun;
+
+/**
+ * @brief Allocates a run for an NFA
+ *
+ * @param nfa The NFA the run will simulate (must outlive the run)
+ * @param stats Its measurements from measure_nfa(), or NULL to measure it here
+ *
+ * @returns A pointer to the run, or NULL on failure
+ */
+NfaRun* create_nfa_run(Nfa* nfa, const NfaStats* stats);
+
+/**
+ * @brief Frees a run (the NFA is left alone)
+ */
+void free_nfa_run(NfaRun* run);
+
 /**
  * @brief Simulates an NFA against a given string
- * 
+ *
+ * A one-off convenience: it measures the NFA and allocates a run for this
+ * call alone. Use simulate_nfa_run() to match many strings.
+ *
  * @param nfa The NFA (Start State) to emulate
- * 
+ *
  * @returns 1 (true) if the string is accepted
- * 
+ *
  * @returns 0 (false) if the string is rejected
  */
 int simulate_nfa(Nfa* nfa, const char* str);
 
+/**
+ * @brief Simulates a run's NFA against a given string
+ *
+ * @returns 1 (true) if the string is accepted, 0 (false) otherwise
+ */
+int simulate_nfa_run(NfaRun* run, const char* str);
+
+/**
+ * @brief Checks whether a match occurs anywhere in a buffer
+ *
+ * The start state is re-entered after every character, the same way
+ * dfa_has_match() restarts, so no DFA has to be built
+ *
+ * @param run A run for the NFA to emulate
+ * @param text The buffer to scan (need not be null-terminated)
+ * @param length The number of bytes to scan
+ *
+ * @returns 1 if some match ends inside the buffer, 0 otherwise
+ */
+int nfa_has_match(NfaRun* run, const char* text, size_t length);
+
+/**
+ * @brief Finds the leftmost-longest match inside a string, like
+ * search_dfa() but by simulating the reversed and forward NFAs directly
+ *
+ * @param forward A run for the NFA of the regex
+ * @param reverse A run for its reversal, see reverse_nfa()
+ * @param match_start Receives the index of the first matched character
+ * @param match_end Receives the index one past the last matched character
+ *
+ * @returns 1 if a match was found, 0 otherwise
+ */
+int search_nfa(NfaRun* forward, NfaRun* reverse, const char* str, int* match_start, int* match_end);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef TOKENS_H
+#define TOKENS_H
+
+#include <stddef.h>
+
+// Every kind of token in the Determa language
+typedef enum TokenType {
+    // Keywords (listed before TOKEN_ID so they win ties in the lexer)
+    TOKEN_VAR,
+    TOKEN_PRINT,
+
+    // Literals and names
+    TOKEN_ID,
+    TOKEN_INT,
+
+    // Operators and punctuation
+    TOKEN_PLUS,
+    TOKEN_MINUS,
+    TOKEN_STAR,
+    TOKEN_SLASH,
+    TOKEN_ASSIGN,
+    TOKEN_SEMICOLON,
+    TOKEN_LPAREN,
+    TOKEN_RPAREN,
+
+    // Recognised by the lexer's DFA but skipped, never returned
+    TOKEN_WHITESPACE,
+    TOKEN_COMMENT,
+
+    TOKEN_ERROR,    // A character no token pattern accepts
+    TOKEN_EOF
+} TokenType;
+
+/**
+ * @struct Token
+ * @brief A token as a view into the source buffer.
+ *
+ * The lexeme is not copied: it is the 'length' bytes starting at
+ * source + offset, so producing a token never allocates.
+ */
+typedef struct Token {
+    TokenType type;
+    size_t offset;  // Index of the token's first byte in the source
+    size_t length;  // Number of bytes in the lexeme
+    int line;       // 1-based line the token starts on
+} Token;
+
+#endif // TOKENS_H
@@ -0,0 +1,114 @@
+#ifndef TRIGRAM_H
+#define TRIGRAM_H
+
+#include <stdio.h>
+#include "planner.h"
+#include "regex_ast.h"
+#include "mapped_file.h"
+
+// The kinds of node in a trigram query
+typedef enum TrigramQueryType {
+    QUERY_ALL,      // Matches every block (no usable trigram)
+    QUERY_TRIGRAM,  // Blocks containing one trigram
+    QUERY_AND,      // Blocks matching every child
+    QUERY_OR        // Blocks matching at least one child
+} TrigramQueryType;
+
+/**
+ * @struct TrigramQuery
+ * @brief A boolean query over trigrams that every matching block satisfies.
+ * It never rules out a block that could match; it only narrows the search.
+ */
+typedef struct TrigramQuery {
+    TrigramQueryType type;
+    unsigned int trigram;           // QUERY_TRIGRAM: bytes packed as (a << 16) | (b << 8) | c
+    struct TrigramQuery** children; // QUERY_AND / QUERY_OR
+    int num_children;
+} TrigramQuery;
+
+/**
+ * @struct TrigramIndex
+ * @brief An index file mapped into memory, with pointers to its sections.
+ *
+ * On-disk layout (all integers little-endian):
+ *   header    "TRG1", u32 files, u32 blocks, u32 trigrams, u32 block size,
+ *             u32 postings bytes, u32 string bytes, u32 reserved
+ *   files     per file:    u32 path offset, u32 reserved, u64 file size
+ *   blocks    per block:   u32 file, u32 length, u64 offset, u64 first line
+ *   trigrams  per trigram: u32 trigram, u32 block count, u32 postings offset
+ *             (sorted by trigram, for binary search)
+ *   postings  block ids of each trigram, delta-coded as varints
+ *   strings   the file paths, null-terminated
+ */
+typedef struct TrigramIndex {
+    MappedFile file;
+    unsigned int num_files;
+    unsigned int num_blocks;
+    unsigned int num_trigrams;
+    const unsigned char* files;
+    const unsigned char* blocks;
+    const unsigned char* trigrams;
+    const unsigned char* postings;
+    const char* strings;
+    size_t postings_size;
+} TrigramIndex;
+
+/**
+ * @brief Builds an index of the trigrams in every block of the given files.
+ * Directories are indexed recursively, in sorted order. Files are split
+ * into blocks of about 'block_size' bytes on line boundaries.
+ * @param paths The files and directories to index.
+ * @param num_paths The number of entries in 'paths'.
+ * @param index_path Where to write the index.
+ * @param block_size Target block size in bytes (0 for the default, 64 KiB).
+ * @return 0 on success, -1 on failure.
+ */
+int build_trigram_index(char* const* paths, int num_paths, const char* index_path, size_t block_size);
+
+/**
+ * @brief Maps an index file built by build_trigram_index().
+ * Every offset and id in the tables is checked against the section it
+ * points into, so a damaged file is rejected instead of read out of bounds.
+ * @return A pointer to the index, or NULL if it is missing or malformed.
+ */
+TrigramIndex* open_trigram_index(const char* index_path);
+
+/**
+ * @brief Unmaps and frees an index.
+ */
+void close_trigram_index(TrigramIndex* index);
+
+/**
+ * @brief Derives the trigram query a regex implies from its syntax tree.
+ * A literal run requires all of its trigrams, concatenation ANDs its parts,
+ * alternation ORs them, and stars and classes require nothing.
+ * @param node The (optimized) syntax tree, see optimize_ast().
+ * @return The query, or NULL on allocation failure.
+ */
+TrigramQuery* plan_trigram_query(const RegexNode* node);
+
+/**
+ * @brief Prints a query, e.g. ("abc" AND ("xyz" OR "uvw")).
+ */
+void print_trigram_query(const TrigramQuery* query, FILE* out);
+
+/**
+ * @brief Frees a query and all of its children.
+ */
+void free_trigram_query(TrigramQuery* query);
+
+/**
+ * @brief Prints every matching line in the blocks the query selects.
+ * Only candidate blocks are read and scanned; output is "path:line:text"
+ * in file order, the same as grep_paths().
+ * @param index The mapped index.
+ * @param query The query from plan_trigram_query().
+ * @param plan A PLAN_SEARCH plan from plan_engine().
+ * @param out Where to write the matching lines.
+ * @param num_candidates Receives the number of blocks that were scanned.
+ * @return The number of matching lines, or -1 on failure.
+ */
+long search_trigram_index(TrigramIndex* index, const TrigramQuery* query, const EnginePlan* plan,
+                          FILE* out, unsigned int* num_candidates);
+
+#endif // TRIGRAM_H
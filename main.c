@@ -5,54 +5,373 @@
 #include "nfa.h"
 #include "simulator.h"
 #include "dfa.h"
+#include "shift_and.h"
+#include "regex_ast.h"
+#include "lexer.h"
+#include "grep.h"
+#include "trigram.h"
+#include "aho_corasick.h"
+#include "planner.h"
 
-int main(int argc, char* argv[]) {
-    if (argc < 3 || argc > 4) {
-        fprintf(stderr, "Usage: %s [--dfa] <regex_pattern> <string_to_test>\n", argv[0]);
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [--glushkov] [--dfa-budget <states>] [--nfa | --dfa | --search | --not | --and <regex> | --and-not <regex>] <regex_pattern> <string_to_test>\n", program);
+    fprintf(stderr, "       %s --lex <source_file>\n", program);
+    fprintf(stderr, "       %s --grep [--threads <n>] [--dfa-budget <states>] <regex_pattern> <file_or_directory>...\n", program);
+    fprintf(stderr, "       %s --index <index_file> <file_or_directory>...\n", program);
+    fprintf(stderr, "       %s --indexed-grep <index_file> <regex_pattern>\n", program);
+}
+
+/**
+ * @brief Tokenizes a source file with the lexer DFA and prints each token.
+ * @return 0 if the whole file tokenized cleanly, 1 otherwise.
+ */
+static int run_lexer(const char* path) {
+    printf("Starting lexer...\n\n");
+    printf("Source File:        %s\n", path);
+
+    printf("\n--- Phase 1: Token DFA Construction ---\n");
+    Dfa* dfa = build_lexer_dfa();
+    if (dfa == NULL) {
+        fprintf(stderr, "Error building token DFA.\n");
+        return 1;
+    }
+    printf("Token DFA constructed successfully (%d states).\n", dfa->num_states);
+
+    Lexer lexer;
+    if (lexer_open_file(&lexer, dfa, path) != 0) {
+        perror("Error opening source file");
+        free_dfa(dfa);
+        return 1;
+    }
+
+    printf("\n--- Phase 2: Tokenization ---\n");
+    int num_tokens = 0;
+    int num_errors = 0;
+    Token token;
+    do {
+        token = get_next_token(&lexer);
+        printf("%4d  %-16s '%.*s'\n", token.line, token_type_name(token.type),
+               (int)token.length, lexer.source + token.offset);
+        num_tokens++;
+        if (token.type == TOKEN_ERROR) num_errors++;
+    } while (token.type != TOKEN_EOF);
+
+    lexer_close(&lexer);
+    free_dfa(dfa);
+
+    printf("\nTokens: %d, Errors: %d\n", num_tokens, num_errors);
+    return num_errors == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Phase 1: preprocesses, converts to postfix and optimizes a regex,
+ * printing each intermediate form if 'verbose' is set.
+ * All buffers are sized from the input, so patterns of any length work.
+ * @return The postfix regex (free it when done), or NULL on failure.
+ */
+static char* parse_to_postfix(const char* infix_regex, int verbose) {
+    size_t infix_length = strlen(infix_regex);
+    char* preprocessed_regex = (char*)malloc(2 * infix_length + 2); // Worst case: a '.' after every char
+    char* postfix_regex = (char*)malloc(2 * infix_length + 2);
+    if (!preprocessed_regex || !postfix_regex) {
+        perror("Failed to allocate regex buffers");
+        free(preprocessed_regex);
+        free(postfix_regex);
+        return NULL;
+    }
+
+    preprocess_regex(infix_regex, preprocessed_regex, (int)(2 * infix_length + 2));
+    if (verbose) printf("Preprocessed Regex: %s\n", preprocessed_regex);
+
+    int status = regex_to_postfix(preprocessed_regex, postfix_regex, (int)(2 * infix_length + 2));
+    free(preprocessed_regex);
+    if (status != 0) {
+        fprintf(stderr, "Error converting to postfix.\n");
+        free(postfix_regex);
+        return NULL;
+    }
+    if (verbose) printf("Postfix Notation:   %s\n", postfix_regex);
+
+    // Rewrite the syntax tree so redundant structure never becomes states.
+    // If anything goes wrong we simply keep the unoptimized postfix.
+    RegexNode* ast = build_ast_from_postfix(postfix_regex);
+    if (ast) {
+        ast = optimize_ast(ast);
+        int optimized_size = 2 * (int)strlen(postfix_regex) + 2;
+        char* optimized_regex = (char*)malloc(optimized_size);
+        if (optimized_regex && ast_to_postfix(ast, optimized_regex, optimized_size) == 0) {
+            free(postfix_regex);
+            postfix_regex = optimized_regex;
+        } else {
+            free(optimized_regex);
+        }
+        free_ast(ast);
+    }
+    if (verbose) printf("Optimized Postfix:  %s\n", postfix_regex);
+    return postfix_regex;
+}
+
+/**
+ * @brief Prints every line of the given files and directories that contains
+ * a match. Only the matching lines go to stdout; the summary goes to stderr.
+ * @return 0 if any line matched, 1 otherwise.
+ */
+static int run_grep(int argc, char* argv[]) {
+    GrepOptions options = { 0, 0, 0 };
+    DfaBudget budget = { PLANNER_MAX_DFA_STATES, PLANNER_MAX_DFA_BYTES };
+    int arg = 2;
+    while (arg + 1 < argc) {
+        if (strcmp(argv[arg], "--threads") == 0) {
+            options.num_threads = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "--dfa-budget") == 0 && atoi(argv[arg + 1]) > 0) {
+            budget.max_states = atoi(argv[arg + 1]);
+        } else {
+            break;
+        }
+        arg += 2;
+    }
+    if (argc - arg < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    char* postfix_regex = parse_to_postfix(argv[arg], 0);
+    if (postfix_regex == NULL) {
         return 1;
     }
 
+    // One engine (a DFA unless the pattern is over budget), shared
+    // read-only by every matcher thread
+    Nfa* nfa = build_nfa_from_postfix(postfix_regex);
+    EnginePlan* plan = nfa ? plan_engine(nfa, argv[arg], postfix_regex, PLAN_SEARCH, &budget) : NULL;
+    free(postfix_regex);
+    if (plan == NULL) {
+        fprintf(stderr, "Error building search engine.\n");
+        free_nfa(nfa);
+        return 1;
+    }
+    fprintf(stderr, "Engine: %s (%s)\n", engine_name(plan->engine), plan->reason);
+
+    long num_matches = grep_paths(plan, argv + arg + 1, argc - arg - 1, &options, stdout);
+    fflush(stdout);
+
+    free_engine_plan(plan);
+    free_nfa(nfa);
+
+    fprintf(stderr, "Matching lines: %ld\n", num_matches < 0 ? 0 : num_matches);
+    return num_matches > 0 ? 0 : 1;
+}
+
+/**
+ * @brief Builds a trigram index over files and directories, then reports its size.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_index(int argc, char* argv[]) {
+    if (argc < 4) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (build_trigram_index(argv + 3, argc - 3, argv[2], 0) != 0) {
+        fprintf(stderr, "Error building trigram index.\n");
+        return 1;
+    }
+
+    TrigramIndex* index = open_trigram_index(argv[2]);
+    if (index == NULL) {
+        return 1;
+    }
+    printf("Indexed %u files in %u blocks (%u distinct trigrams, %lu bytes).\n",
+           index->num_files, index->num_blocks, index->num_trigrams,
+           (unsigned long)index->file.length);
+    close_trigram_index(index);
+    return 0;
+}
+
+/**
+ * @brief Searches an indexed corpus: the regex's trigram query picks the
+ * candidate blocks, and only those are scanned by the planned engine. Matching lines
+ * go to stdout; the query and the statistics go to stderr.
+ * @return 0 if any line matched, 1 otherwise.
+ */
+static int run_indexed_grep(int argc, char* argv[]) {
+    if (argc != 4) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    char* postfix_regex = parse_to_postfix(argv[3], 0);
+    if (postfix_regex == NULL) {
+        return 1;
+    }
+
+    // The planner needs merged literal runs, so plan from the optimized tree
+    RegexNode* ast = build_ast_from_postfix(postfix_regex);
+    if (ast) ast = optimize_ast(ast);
+    TrigramQuery* query = ast ? plan_trigram_query(ast) : NULL;
+    free_ast(ast);
+    if (query == NULL) {
+        fprintf(stderr, "Error planning trigram query.\n");
+        free(postfix_regex);
+        return 1;
+    }
+    fprintf(stderr, "Trigram query: ");
+    print_trigram_query(query, stderr);
+    fprintf(stderr, "\n");
+
+    Nfa* nfa = build_nfa_from_postfix(postfix_regex);
+    EnginePlan* plan = nfa ? plan_engine(nfa, argv[3], postfix_regex, PLAN_SEARCH, NULL) : NULL;
+    free(postfix_regex);
+    TrigramIndex* index = plan ? open_trigram_index(argv[2]) : NULL;
+
+    long num_matches = -1;
+    unsigned int num_candidates = 0;
+    if (index) {
+        fprintf(stderr, "Engine: %s (%s)\n", engine_name(plan->engine), plan->reason);
+        num_matches = search_trigram_index(index, query, plan, stdout, &num_candidates);
+        fflush(stdout);
+        fprintf(stderr, "Candidate blocks: %u of %u\n", num_candidates, index->num_blocks);
+        fprintf(stderr, "Matching lines: %ld\n", num_matches < 0 ? 0 : num_matches);
+    } else if (plan == NULL) {
+        fprintf(stderr, "Error building search engine.\n");
+    }
+
+    close_trigram_index(index);
+    free_trigram_query(query);
+    free_engine_plan(plan);
+    free_nfa(nfa);
+    return num_matches > 0 ? 0 : 1;
+}
+
+/**
+ * @brief Matches a large pure literal alternation with an Aho-Corasick
+ * automaton, skipping the parser and NFA entirely.
+ * @return 0 for a match, 1 otherwise (the same as the regex paths).
+ */
+static int run_aho_corasick(const char* infix_regex, const char* test_string, int use_search) {
+    printf("\n--- Phase 1: Literal Alternation Detected ---\n");
+    printf("Literal characters: %d\n", literal_alternation_size(infix_regex));
+
+    printf("\n--- Phase 2: Aho-Corasick Construction ---\n");
+    AhoCorasick* ac = build_aho_corasick(infix_regex);
+    if (ac == NULL) {
+        return 1;
+    }
+    printf("Automaton built (%d keywords, %d nodes).\n", ac->num_words, ac->num_nodes);
+
+    int is_match;
+    if (use_search) {
+        printf("\n--- Phase 3f: Aho-Corasick Search ---\n");
+        int match_start = 0;
+        int match_end = 0;
+        is_match = search_aho_corasick(ac, test_string, &match_start, &match_end);
+        if (is_match) {
+            printf("Match span: [%d, %d) \"%.*s\"\n", match_start, match_end,
+                   match_end - match_start, test_string + match_start);
+        }
+    } else {
+        printf("\n--- Phase 3f: Trie Match ---\n");
+        is_match = simulate_aho_corasick(ac, test_string);
+    }
+    free_aho_corasick(ac);
+
+    printf("\nResult: %s\n", is_match ? "Match" : "No Match");
+    return is_match ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
     int use_dfa = 0; // toggle for dfa or nfa
+    int force_nfa = 0; // skip the bit-parallel engine even if the pattern fits
+    int use_search = 0; // find a match anywhere in the string instead of a full match
+    int use_glushkov = 0; // build the epsilon-free Glushkov NFA instead of Thompson's
+    int use_complement = 0; // match strings the regex rejects
+    const char* and_regex = NULL; // second pattern that must also match
+    const char* and_not_regex = NULL; // second pattern that must not match
+    DfaBudget budget = { PLANNER_MAX_DFA_STATES, PLANNER_MAX_DFA_BYTES }; // limits for planned DFAs
     const char* infix_regex;
     const char* test_string;
 
-    if (argc == 4) {
-        if (strcmp(argv[1], "--dfa") != 0) {
-            fprintf(stderr, "Invalid flag. Usage: %s [--dfa] <regex...> <string...>\n", argv[0]);
+    // The lexer mode has its own argument list
+    if (argc == 3 && strcmp(argv[1], "--lex") == 0) {
+        return run_lexer(argv[2]);
+    }
+    if (argc > 1 && strcmp(argv[1], "--grep") == 0) {
+        return run_grep(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--index") == 0) {
+        return run_index(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--indexed-grep") == 0) {
+        return run_indexed_grep(argc, argv);
+    }
+
+    // Leading "--" arguments are flags; the last two are the regex and string
+    int arg = 1;
+    while (arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        if (strcmp(argv[arg], "--nfa") == 0) {
+            force_nfa = 1;
+        } else if (strcmp(argv[arg], "--dfa") == 0) {
+            use_dfa = 1;
+        } else if (strcmp(argv[arg], "--search") == 0) {
+            use_search = 1;
+        } else if (strcmp(argv[arg], "--glushkov") == 0) {
+            use_glushkov = 1;
+        } else if (strcmp(argv[arg], "--not") == 0) {
+            use_complement = 1;
+        } else if (strcmp(argv[arg], "--and") == 0 && arg + 1 < argc) {
+            and_regex = argv[++arg];
+        } else if (strcmp(argv[arg], "--and-not") == 0 && arg + 1 < argc) {
+            and_not_regex = argv[++arg];
+        } else if (strcmp(argv[arg], "--dfa-budget") == 0 && arg + 1 < argc && atoi(argv[arg + 1]) > 0) {
+            budget.max_states = atoi(argv[++arg]);
+        } else {
+            fprintf(stderr, "Invalid flag '%s'.\n", argv[arg]);
+            print_usage(argv[0]);
             return 1;
         }
-        use_dfa = 1;
-        infix_regex = argv[2];
-        test_string = argv[3];
-    } else {
-        infix_regex = argv[1];
-        test_string = argv[2];
+        arg++;
     }
 
+    // The boolean combinators all run on a single product DFA
+    int use_product = use_complement || and_regex != NULL || and_not_regex != NULL;
+    if (argc - arg != 2 || use_dfa + force_nfa + use_search + use_product > 1 ||
+        use_complement + (and_regex != NULL) + (and_not_regex != NULL) > 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    infix_regex = argv[arg];
+    test_string = argv[arg + 1];
+
     printf("Starting regex engine...\n\n");
     printf("Input Infix Regex:  %s\n", infix_regex);
     printf("String to test:     %s\n", test_string);
-    printf("\n--- Phase 1: Parsing ---\n");
 
-    char preprocessed_regex[1024];
-    preprocess_regex(infix_regex, preprocessed_regex, sizeof(preprocessed_regex));
-    printf("Preprocessed Regex: %s\n", preprocessed_regex);
+    // Keyword lists too long for the bit-parallel engine go to Aho-Corasick,
+    // unless an engine was requested explicitly
+    if (!use_dfa && !force_nfa && !use_glushkov && !use_product &&
+        literal_alternation_size(infix_regex) > SHIFT_AND_MAX_POSITIONS) {
+        return run_aho_corasick(infix_regex, test_string, use_search);
+    }
 
-    char postfix_regex[1024];
-    if (regex_to_postfix(preprocessed_regex, postfix_regex, sizeof(postfix_regex)) != 0) {
-        fprintf(stderr, "Error converting to postfix.\n");
+    printf("\n--- Phase 1: Parsing ---\n");
+
+    char* postfix_regex = parse_to_postfix(infix_regex, 1);
+    if (postfix_regex == NULL) {
         return 1;
     }
-    printf("Postfix Notation:   %s\n", postfix_regex);
 
     printf("\n--- Phase 2: NFA Construction ---\n");
-    Nfa* nfa = build_nfa_from_postfix(postfix_regex);
+    Nfa* nfa = use_glushkov ? build_glushkov_nfa_from_postfix(postfix_regex)
+                            : build_nfa_from_postfix(postfix_regex);
 
-    if (nfa) {
+    if (nfa && nfa->end) {
         printf("NFA constructed successfully!\n");
         printf("Start State ID: %d, End State ID: %d\n", nfa->start->id, nfa->end->id);
+    } else if (nfa) {
+        printf("Glushkov NFA constructed successfully (epsilon-free)!\n");
+        printf("Start State ID: %d\n", nfa->start->id);
     } else {
         fprintf(stderr, "NFA construction failed.\n");
+        free(postfix_regex);
         return 1;
     }
 
@@ -60,13 +379,84 @@ int main(int argc, char* argv[]) {
     int is_match = 0;
 
     // --- Phase 3: Choose Simulation Path ---
-    if (use_dfa) {
+    if (use_product) {
+        // --- BOOLEAN PATH: one product DFA evaluates the whole rule ---
+        printf("\n--- Phase 3e: Product DFA Construction ---\n");
+        Dfa* dfa = nfa_to_dfa(nfa);
+        Dfa* other_dfa = NULL;
+        Nfa* other_nfa = NULL;
+        const char* other_regex = and_regex ? and_regex : and_not_regex;
+
+        if (other_regex) {
+            printf("Second Pattern:     %s\n", other_regex);
+            char* other_postfix = parse_to_postfix(other_regex, 1);
+            if (other_postfix) {
+                other_nfa = use_glushkov ? build_glushkov_nfa_from_postfix(other_postfix)
+                                         : build_nfa_from_postfix(other_postfix);
+                free(other_postfix);
+            }
+            other_dfa = other_nfa ? nfa_to_dfa(other_nfa) : NULL;
+        }
+
+        Dfa* product = NULL;
+        if (dfa && use_complement) {
+            product = dfa_complement(dfa);
+        } else if (dfa && other_dfa) {
+            product = and_regex ? dfa_intersect(dfa, other_dfa) : dfa_difference(dfa, other_dfa);
+        }
+
+        free_dfa(dfa);
+        free_dfa(other_dfa);
+        free_nfa(other_nfa);
+        if (product == NULL) {
+            fprintf(stderr, "Error building product DFA.\n");
+            free_nfa(nfa);
+            free(postfix_regex);
+            return 1;
+        }
+        printf("Product DFA constructed successfully (%d states).\n", product->num_states);
+
+        printf("\n--- Phase 4: DFA Simulation ---\n");
+        is_match = simulate_dfa(product, test_string);
+        free_dfa(product);
+
+    } else if (use_search) {
+        // --- SEARCH PATH: a reverse pass finds the start, a forward pass the end ---
+        printf("\n--- Phase 3c: Search Engine Planning ---\n");
+        // Keyword lists only get here when --glushkov forced the regular
+        // pipeline, so the planner is not offered Aho-Corasick
+        EnginePlan* plan = plan_engine(nfa, NULL, postfix_regex, PLAN_SPAN, &budget);
+        if (plan == NULL) {
+            fprintf(stderr, "Error building search engine.\n");
+            free_nfa(nfa);
+            free(postfix_regex);
+            return 1;
+        }
+        printf("Engine: %s (%s)\n", engine_name(plan->engine), plan->reason);
+        if (plan->engine == ENGINE_DFA) {
+            printf("Forward DFA: %d states, Reverse DFA: %d states.\n",
+                   plan->dfa->num_states, plan->reverse_dfa->num_states);
+        }
+
+        printf("\n--- Phase 4: Two-Pass %s Search ---\n", engine_name(plan->engine));
+        int match_start = 0;
+        int match_end = 0;
+        is_match = plan_search(plan, test_string, &match_start, &match_end);
+        if (is_match) {
+            printf("Match span: [%d, %d) \"%.*s\"\n", match_start, match_end,
+                   match_end - match_start, test_string + match_start);
+        }
+
+        free_engine_plan(plan);
+
+    } else if (use_dfa) {
         // --- NEW DFA PATH ---
         printf("\n--- Phase 3a: NFA->DFA Conversion ---\n");
         Dfa* dfa = nfa_to_dfa(nfa);
         if (dfa == NULL) {
             fprintf(stderr, "Error converting NFA to DFA.\n");
-            // (Need to free NFA here in a real app)
+            free_nfa(nfa);
+            free(postfix_regex);
             return 1;
         }
         printf("DFA constructed successfully (%d states).\n", dfa->num_states);
@@ -82,14 +472,32 @@ int main(int argc, char* argv[]) {
         // Clean up the DFA
         free_dfa(dfa);
         
+    } else if (!force_nfa) {
+        // --- PLANNED PATH: Shift-And for small patterns, a DFA within the
+        // budget, and the NFA simulator for anything larger ---
+        printf("\n--- Phase 3d: Engine Planning ---\n");
+        // As above, keyword lists here were forced through the regular pipeline
+        EnginePlan* plan = plan_engine(nfa, NULL, postfix_regex, PLAN_FULL_MATCH, &budget);
+        if (plan == NULL) {
+            fprintf(stderr, "Error planning the match engine.\n");
+            free_nfa(nfa);
+            free(postfix_regex);
+            return 1;
+        }
+        printf("Engine: %s (%s)\n", engine_name(plan->engine), plan->reason);
+
+        printf("\n--- Phase 4: %s Simulation ---\n", engine_name(plan->engine));
+        is_match = plan_match(plan, test_string);
+        free_engine_plan(plan);
+
     } else {
         // --- ORIGINAL NFA PATH ---
         printf("\n--- Phase 3b: NFA Simulation ---\n");
         is_match = simulate_nfa(nfa, test_string);
     }
     
-    // (We still need to free the NFA itself)
-    // free_nfa(nfa); // When you implement this
+    free_nfa(nfa);
+    free(postfix_regex);
 
     printf("\nResult: %s\n", is_match ? "Match" : "No Match");
 
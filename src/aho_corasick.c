@@ -0,0 +1,257 @@
+#include "aho_corasick.h"
+#include "parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Returns the single byte a literal operand stands for, or -1 if
+ * the operand can match more than one byte (a real class).
+ */
+static int literal_operand_char(const char* operand) {
+    unsigned char set[256];
+    int member = -1;
+    regex_operand_chars(operand, set);
+    for (int c = 1; c < 256; c++) {
+        if (!set[c]) continue;
+        if (member >= 0) return -1;
+        member = c;
+    }
+    return member;
+}
+
+int literal_alternation_size(const char* regex) {
+    int size = 0;
+    int word_length = 0;
+
+    for (int i = 0; regex[i] != '\0';) {
+        if (regex[i] == '|') {
+            if (word_length == 0) return -1; // Empty alternative: a syntax error
+            word_length = 0;
+            i++;
+            continue;
+        }
+        int length = regex_operand_length(&regex[i]);
+        if (length == 0 || literal_operand_char(&regex[i]) < 0) {
+            return -1; // An operator or a class
+        }
+        word_length++;
+        size++;
+        i += length;
+    }
+    return word_length > 0 ? size : -1;
+}
+
+/**
+ * @brief Returns the child of 'node' along byte 'c', or -1 if there is none.
+ */
+static int find_child(const AhoCorasick* ac, int node, unsigned char c) {
+    if (node == 0) {
+        return ac->root_next[c] ? ac->root_next[c] : -1;
+    }
+    for (int child = ac->first_child[node]; child >= 0 && ac->byte[child] <= c;
+         child = ac->next_sibling[child]) {
+        if (ac->byte[child] == c) return child;
+    }
+    return -1;
+}
+
+/**
+ * @brief Advances the scan by one byte, following failure links until some
+ * node has a child along it (or the root is reached).
+ */
+static int next_node(const AhoCorasick* ac, int node, unsigned char c) {
+    int next;
+    while ((next = find_child(ac, node, c)) < 0 && node != 0) {
+        node = ac->fail[node];
+    }
+    return next < 0 ? 0 : next;
+}
+
+/**
+ * @brief Returns the child of 'node' along byte 'c', creating it if needed.
+ * Sibling lists are kept sorted so lookups can stop early.
+ */
+static int add_child(AhoCorasick* ac, int node, unsigned char c) {
+    int existing = find_child(ac, node, c);
+    if (existing >= 0) return existing;
+
+    int child = ac->num_nodes++;
+    ac->byte[child] = c;
+    ac->first_child[child] = -1;
+    ac->depth[child] = ac->depth[node] + 1;
+    ac->fail[child] = 0;
+    ac->match_length[child] = 0;
+
+    // Splice into the parent's sorted list
+    int* link = &ac->first_child[node];
+    while (*link >= 0 && ac->byte[*link] < c) {
+        link = &ac->next_sibling[*link];
+    }
+    ac->next_sibling[child] = *link;
+    *link = child;
+
+    if (node == 0) ac->root_next[c] = child;
+    return child;
+}
+
+/**
+ * @brief Computes failure links breadth-first, so every node's suffix
+ * (which is shallower) is finished before the node itself.
+ */
+static int link_failures(AhoCorasick* ac) {
+    int* queue = (int*)malloc(ac->num_nodes * sizeof(int));
+    if (!queue) {
+        perror("Failed to allocate Aho-Corasick queue");
+        return -1;
+    }
+    int head = 0, tail = 0;
+    queue[tail++] = 0;
+
+    while (head < tail) {
+        int node = queue[head++];
+        for (int child = ac->first_child[node]; child >= 0; child = ac->next_sibling[child]) {
+            if (node != 0) {
+                // Follow the parent's failure chain until some suffix can
+                // be extended by this byte
+                int suffix = ac->fail[node];
+                int next;
+                while ((next = find_child(ac, suffix, ac->byte[child])) < 0 && suffix != 0) {
+                    suffix = ac->fail[suffix];
+                }
+                ac->fail[child] = next < 0 ? 0 : next;
+            }
+
+            // A keyword ends here if the node is one, or else if one ends at its suffix
+            if (ac->match_length[child] == 0) {
+                ac->match_length[child] = ac->match_length[ac->fail[child]];
+            }
+            queue[tail++] = child;
+        }
+    }
+
+    free(queue);
+    return 0;
+}
+
+AhoCorasick* build_aho_corasick(const char* regex) {
+    int size = literal_alternation_size(regex);
+    if (size <= 0) {
+        fprintf(stderr, "Error: Not a pure literal alternation.\n");
+        return NULL;
+    }
+
+    AhoCorasick* ac = (AhoCorasick*)calloc(1, sizeof(AhoCorasick));
+    if (!ac) {
+        perror("Failed to allocate AhoCorasick");
+        return NULL;
+    }
+
+    // The trie can't have more nodes than there are literal characters
+    int max_nodes = size + 1;
+    ac->byte = (unsigned char*)malloc(max_nodes);
+    ac->first_child = (int*)malloc(max_nodes * sizeof(int));
+    ac->next_sibling = (int*)malloc(max_nodes * sizeof(int));
+    ac->depth = (int*)malloc(max_nodes * sizeof(int));
+    ac->fail = (int*)malloc(max_nodes * sizeof(int));
+    ac->match_length = (int*)malloc(max_nodes * sizeof(int));
+    if (!ac->byte || !ac->first_child || !ac->next_sibling ||
+        !ac->depth || !ac->fail || !ac->match_length) {
+        perror("Failed to allocate Aho-Corasick nodes");
+        free_aho_corasick(ac);
+        return NULL;
+    }
+
+    // The root
+    ac->num_nodes = 1;
+    ac->byte[0] = 0;
+    ac->first_child[0] = -1;
+    ac->next_sibling[0] = -1;
+    ac->depth[0] = 0;
+    ac->fail[0] = 0;
+    ac->match_length[0] = 0;
+
+    // Insert each alternative as it is read
+    int node = 0;
+    for (int i = 0;; ) {
+        if (regex[i] == '|' || regex[i] == '\0') {
+            ac->match_length[node] = ac->depth[node]; // Mark the keyword's end
+            ac->num_words++;
+            if (regex[i] == '\0') break;
+            node = 0;
+            i++;
+            continue;
+        }
+        node = add_child(ac, node, (unsigned char)literal_operand_char(&regex[i]));
+        i += regex_operand_length(&regex[i]);
+    }
+
+    if (link_failures(ac) != 0) {
+        free_aho_corasick(ac);
+        return NULL;
+    }
+    return ac;
+}
+
+int simulate_aho_corasick(AhoCorasick* ac, const char* str) {
+    int node = 0;
+    for (int i = 0; str[i] != '\0'; i++) {
+        node = find_child(ac, node, (unsigned char)str[i]);
+        if (node < 0) return 0; // Not a prefix of any keyword
+    }
+    // The node is a keyword itself (not just a suffix of one)
+    return node != 0 && ac->match_length[node] == ac->depth[node];
+}
+
+int search_aho_corasick(AhoCorasick* ac, const char* str, int* match_start, int* match_end) {
+    int start = -1;
+    int end = -1;
+    int node = 0;
+    for (int i = 0; str[i] != '\0'; i++) {
+        node = next_node(ac, node, (unsigned char)str[i]);
+
+        // The longest keyword ending here starts leftmost among them; a
+        // later end with the same start is a longer match
+        if (ac->match_length[node] > 0) {
+            int keyword_start = i + 1 - ac->match_length[node];
+            if (start < 0 || keyword_start <= start) {
+                start = keyword_start;
+                end = i + 1;
+            }
+        }
+
+        // Any later keyword lies within the current trie path, so once that
+        // path starts past the best match, nothing can beat it
+        if (start >= 0 && i + 1 - ac->depth[node] > start) {
+            break;
+        }
+    }
+
+    if (start < 0) {
+        return 0;
+    }
+    *match_start = start;
+    *match_end = end;
+    return 1;
+}
+
+int aho_corasick_has_match(const AhoCorasick* ac, const char* text, size_t length) {
+    int node = 0;
+    for (size_t i = 0; i < length; i++) {
+        node = next_node(ac, node, (unsigned char)text[i]);
+        if (ac->match_length[node] > 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void free_aho_corasick(AhoCorasick* ac) {
+    if (!ac) return;
+    free(ac->byte);
+    free(ac->first_child);
+    free(ac->next_sibling);
+    free(ac->depth);
+    free(ac->fail);
+    free(ac->match_length);
+    free(ac);
+}
@@ -2,30 +2,58 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 
 // --- Static Globals for the Builder ---
 // These are used only during the nfa_to_dfa conversion process.
+// States are processed in creation order, so all_states is the worklist.
 static Dfa* dfa_graph = NULL;
-static DfaState* worklist[MAX_DFA_STATES];
 static int worklist_head = 0;
-static int worklist_tail = 0;
+static const DfaBudget* build_budget = NULL;
+static DfaLimit budget_exceeded = DFA_WITHIN_BUDGET;
+
+// Duplicate check for the set being filled: set_stamps[id - set_min_id]
+// equals set_generation once that NFA state is in the set
+static int* set_stamps = NULL;
+static int set_num_stamps = 0;
+static int set_generation = 0;
+static int set_min_id = 0;
+
+// Open-addressing table of the DFA states built so far, keyed by set_hash
+// and kept at most half full, so looking up a set does not scan every state
+static DfaState** state_table = NULL;
+static size_t state_table_mask = 0;
 
 // --- Helper Functions ---
 
 /**
- * @brief (Copied from simulator.c)
- * Recursively adds a state and its epsilon-closure to a set.
+ * @brief Starts filling a new, empty NFA state set.
  */
-static void add_state_to_set(State* state, State** set, int* count) {
-    if (state == NULL) return;
-    for (int i = 0; i < *count; i++) {
-        if (set[i] == state) return; // Already present
+static void begin_set(void) {
+    if (set_generation == INT_MAX) {
+        memset(set_stamps, 0, set_num_stamps * sizeof(int));
+        set_generation = 0;
     }
+    set_generation++;
+}
+
+/**
+ * @brief Adds a state and its epsilon-closure to a set.
+ * The set must have room for every state of the NFA; the stamps make
+ * sure no state is added twice, so it can never overflow.
+ * Epsilon-free (Glushkov) NFAs pass follow_epsilon = 0 and skip the closure.
+ */
+static void add_state_to_set(State* state, State** set, int* count, int follow_epsilon) {
+    if (state == NULL) return;
+    int* stamp = &set_stamps[state->id - set_min_id];
+    if (*stamp == set_generation) return; // Already present
+    *stamp = set_generation;
     set[(*count)++] = state;
+    if (!follow_epsilon) return;
 
     for (int i = 0; i < state->num_transitions; i++) {
         if (state->transitions[i]->trigger_char == '\0') {
-            add_state_to_set(state->transitions[i]->target_state, set, count);
+            add_state_to_set(state->transitions[i]->target_state, set, count, 1);
         }
     }
 }
@@ -47,6 +75,17 @@ static void sort_nfa_state_set(State** set, int count) {
     qsort(set, count, sizeof(State*), state_ptr_compare);
 }
 
+/**
+ * @brief Hashes a sorted NFA state set (FNV-1a over the state IDs).
+ */
+static unsigned int hash_nfa_state_set(State** set, int count) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < count; i++) {
+        hash = (hash ^ (unsigned int)set[i]->id) * 16777619u;
+    }
+    return hash;
+}
+
 /**
  * @brief Checks if two (sorted) NFA state sets are identical.
  */
@@ -59,99 +98,226 @@ static int are_sets_equal(State** set1, int count1, State** set2, int count2) {
 }
 
 /**
- * @brief Finds if a DFA state for a given NFA-state-set already exists.
+ * @brief Inserts a DFA state into an open-addressing table by its set hash.
  */
-static DfaState* find_dfa_state_by_nfa_set(State** set, int count) {
-    // We must sort the input set to compare it against the (already sorted)
-    // sets stored in the existing DFA states.
-    sort_nfa_state_set(set, count);
+static void insert_state_table(DfaState** slots, size_t mask, DfaState* state) {
+    size_t i = state->set_hash & mask;
+    while (slots[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = state;
+}
 
+/**
+ * @brief Doubles the state table before it gets crowded.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int grow_state_table(void) {
+    size_t new_mask = state_table_mask * 2 + 1;
+    DfaState** grown = (DfaState**)calloc(new_mask + 1, sizeof(DfaState*));
+    if (!grown) {
+        perror("Failed to grow DFA state table");
+        return -1;
+    }
     for (int i = 0; i < dfa_graph->num_states; i++) {
-        if (are_sets_equal(dfa_graph->all_states[i]->nfa_states,
-                           dfa_graph->all_states[i]->num_nfa_states,
-                           set, count)) {
-            return dfa_graph->all_states[i];
+        insert_state_table(grown, new_mask, dfa_graph->all_states[i]);
+    }
+    free(state_table);
+    state_table = grown;
+    state_table_mask = new_mask;
+    return 0;
+}
+
+/**
+ * @brief Finds if a DFA state for a given NFA-state-set already exists.
+ * The set must already be sorted, and 'hash' must be its hash.
+ */
+static DfaState* find_dfa_state_by_nfa_set(State** set, int count, unsigned int hash) {
+    for (size_t i = hash & state_table_mask; state_table[i] != NULL; i = (i + 1) & state_table_mask) {
+        DfaState* s = state_table[i];
+        if (s->set_hash == hash &&
+            are_sets_equal(s->nfa_states, s->num_nfa_states, set, count)) {
+            return s;
         }
     }
     return NULL; // Not found
 }
 
 /**
- * @brief Creates a new DfaState, adds it to the graph, and to the worklist.
+ * @brief Makes room for one more state in a DFA's state list.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int reserve_state_slot(Dfa* dfa) {
+    if (dfa->num_states < dfa->max_states) return 0;
+
+    int new_max = dfa->max_states ? dfa->max_states * 2 : 16;
+    DfaState** grown = (DfaState**)realloc(dfa->all_states, new_max * sizeof(DfaState*));
+    if (!grown) {
+        perror("Failed to grow DFA state list");
+        return -1;
+    }
+    dfa->all_states = grown;
+    dfa->max_states = new_max;
+    return 0;
+}
+
+/**
+ * @brief Creates a new DfaState for a sorted NFA state set and adds it to
+ * the graph (and so to the worklist). Returns NULL, with budget_exceeded
+ * set to the limit it hit, if the state would not fit the budget.
  */
-static DfaState* create_dfa_state(State** set, int count) {
-    if (dfa_graph->num_states >= MAX_DFA_STATES) {
-        fprintf(stderr, "Error: Maximum number of DFA states reached.\n");
+static DfaState* create_dfa_state(State** set, int count, unsigned int hash) {
+    size_t bytes = sizeof(DfaState) + count * sizeof(State*);
+    if (dfa_graph->num_states >= build_budget->max_states) {
+        budget_exceeded = DFA_STATE_LIMIT;
+        return NULL;
+    }
+    if (build_budget->max_bytes > 0 && dfa_graph->num_bytes + bytes > build_budget->max_bytes) {
+        budget_exceeded = DFA_BYTE_LIMIT;
+        return NULL;
+    }
+    if (reserve_state_slot(dfa_graph) != 0) {
+        return NULL;
+    }
+    if ((size_t)(dfa_graph->num_states + 1) * 2 > state_table_mask && grow_state_table() != 0) {
         return NULL;
     }
 
     DfaState* dfa_state = (DfaState*)malloc(sizeof(DfaState));
-    if (!dfa_state) {
+    State** nfa_states = (State**)malloc(count * sizeof(State*));
+    if (!dfa_state || !nfa_states) {
         perror("Failed to allocate DfaState");
+        free(dfa_state);
+        free(nfa_states);
         return NULL;
     }
 
     // Initialize the DfaState
     dfa_state->id = dfa_graph->num_states;
+    dfa_state->nfa_states = nfa_states;
     dfa_state->num_nfa_states = count;
+    dfa_state->set_hash = hash;
     dfa_state->is_accepting = 0;
+    dfa_state->accept_id = -1;
     memset(dfa_state->transitions, 0, sizeof(dfa_state->transitions)); // All transitions are NULL (dead)
 
-    // Copy the NFA state set and sort it
+    // Copy the (already sorted) NFA state set
     memcpy(dfa_state->nfa_states, set, count * sizeof(State*));
-    sort_nfa_state_set(dfa_state->nfa_states, dfa_state->num_nfa_states);
 
-    // Check if this new DFA state is an accepting state
+    // Check if this new DFA state is an accepting state. When accepting
+    // NFA states are tagged, the lowest tag (highest priority) wins.
     for (int i = 0; i < count; i++) {
-        if (dfa_state->nfa_states[i]->is_accepting) {
+        State* nfa_s = dfa_state->nfa_states[i];
+        if (nfa_s->is_accepting) {
             dfa_state->is_accepting = 1;
-            break;
+            if (nfa_s->accept_id >= 0 &&
+                (dfa_state->accept_id < 0 || nfa_s->accept_id < dfa_state->accept_id)) {
+                dfa_state->accept_id = nfa_s->accept_id;
+            }
         }
     }
 
-    // Add to the main graph and worklist
+    // Add to the main graph (and so to the worklist) and the lookup table
     dfa_graph->all_states[dfa_graph->num_states++] = dfa_state;
-    worklist[worklist_tail++] = dfa_state;
+    dfa_graph->num_bytes += bytes;
+    insert_state_table(state_table, state_table_mask, dfa_state);
 
     return dfa_state;
 }
 
+/**
+ * @brief Looks up the DFA state for an NFA state set, creating it if it
+ * does not exist yet. Returns NULL if it could not be created.
+ */
+static DfaState* find_or_create_dfa_state(State** set, int count) {
+    // Sort the set so it can be compared against the (already sorted)
+    // sets stored in the existing DFA states.
+    sort_nfa_state_set(set, count);
+    unsigned int hash = hash_nfa_state_set(set, count);
+
+    DfaState* existing = find_dfa_state_by_nfa_set(set, count, hash);
+    return existing ? existing : create_dfa_state(set, count, hash);
+}
 
-// --- Public Functions ---
 
-Dfa* nfa_to_dfa(Nfa* nfa) {
-    // 1. Initialize the global DFA graph and worklist
-    dfa_graph = (Dfa*)malloc(sizeof(Dfa));
-    if (!dfa_graph) {
+/**
+ * @brief Runs subset construction over an NFA.
+ * @param nfa The NFA to convert.
+ * @param unanchored If 1, the start state's closure is folded into every
+ *                   transition, so the DFA can begin a match at any position
+ *                   (equivalent to prefixing the regex with "any string").
+ * @param budget The limits; the build fails once a new state would pass them.
+ * @param over_budget Receives the limit the build ran into, if any.
+ */
+static Dfa* build_dfa(Nfa* nfa, int unanchored, const DfaBudget* budget, DfaLimit* over_budget) {
+    *over_budget = DFA_WITHIN_BUDGET;
+
+    // 1. Size the scratch set for the whole NFA: a set holds each NFA
+    // state at most once, so it can never outgrow this.
+    NfaStats stats;
+    if (measure_nfa(nfa, &stats) != 0) {
+        perror("Failed to measure NFA");
+        return NULL;
+    }
+    State** next_set = (State**)malloc(stats.num_states * sizeof(State*));
+    set_num_stamps = stats.max_id - stats.min_id + 1;
+    set_stamps = (int*)calloc(set_num_stamps, sizeof(int));
+    set_generation = 0;
+    set_min_id = stats.min_id;
+
+    // 2. Initialize the global DFA graph and its lookup table
+    dfa_graph = (Dfa*)calloc(1, sizeof(Dfa));
+    state_table_mask = 63;
+    state_table = (DfaState**)calloc(state_table_mask + 1, sizeof(DfaState*));
+    if (!next_set || !set_stamps || !dfa_graph || !state_table) {
         perror("Failed to allocate Dfa");
+        free(next_set);
+        free(set_stamps);
+        free(dfa_graph);
+        free(state_table);
+        set_stamps = NULL;
+        state_table = NULL;
         return NULL;
     }
-    dfa_graph->num_states = 0;
-    dfa_graph->start_state = NULL;
-    memset(dfa_graph->all_states, 0, sizeof(dfa_graph->all_states));
-    
+    build_budget = budget;
+    budget_exceeded = DFA_WITHIN_BUDGET;
     worklist_head = 0;
-    worklist_tail = 0;
 
-    // 2. Create the DFA's start state.
+    // 3. Create the DFA's start state.
     // This is the epsilon-closure of the NFA's start state.
-    State* start_set[MAX_NFA_STATES_PER_DFA_STATE];
     int start_count = 0;
-    add_state_to_set(nfa->start, start_set, &start_count);
-    
-    dfa_graph->start_state = create_dfa_state(start_set, start_count);
+    int follow_epsilon = !nfa->is_epsilon_free;
+    begin_set();
+    add_state_to_set(nfa->start, next_set, &start_count, follow_epsilon);
+
+    dfa_graph->start_state = find_or_create_dfa_state(next_set, start_count);
+    int failed = dfa_graph->start_state == NULL;
+
+    // 4. Process the worklist (Subset Construction Algorithm)
+    while (!failed && worklist_head < dfa_graph->num_states) {
+        DfaState* current_dfa_state = dfa_graph->all_states[worklist_head++];
+
+        // Only characters that label some outgoing NFA transition can lead
+        // anywhere, so collect those instead of trying all 255 bytes.
+        unsigned char used[256] = {0};
+        for (int i = 0; i < current_dfa_state->num_nfa_states; i++) {
+            State* nfa_s = current_dfa_state->nfa_states[i];
+            for (int j = 0; j < nfa_s->num_transitions; j++) {
+                used[(unsigned char)nfa_s->transitions[j]->trigger_char] = 1;
+            }
+        }
 
-    // 3. Process the worklist (Subset Construction Algorithm)
-    while (worklist_head < worklist_tail) {
-        DfaState* current_dfa_state = worklist[worklist_head++];
+        for (int c = 1; c < 256 && !failed; c++) {
+            if (!used[c]) continue;
 
-        // We must check transitions for every possible character.
-        // For simplicity, we check all printable ASCII characters.
-        for (int c = 32; c < 127; c++) {
-            
             // This set will hold the *next* set of NFA states
-            State* next_set[MAX_NFA_STATES_PER_DFA_STATE];
             int next_count = 0;
+            begin_set();
+
+            // In unanchored mode a new match may start after any character
+            if (unanchored) {
+                add_state_to_set(nfa->start, next_set, &next_count, follow_epsilon);
+            }
 
             // For each NFA state 's' in our current DFA state...
             for (int i = 0; i < current_dfa_state->num_nfa_states; i++) {
@@ -165,7 +331,7 @@ Dfa* nfa_to_dfa(Nfa* nfa) {
                     if (t->trigger_char == (char)c) {
                         // If it matches, add the *epsilon-closure* of the
                         // target state to our 'next_set'.
-                        add_state_to_set(t->target_state, next_set, &next_count);
+                        add_state_to_set(t->target_state, next_set, &next_count, follow_epsilon);
                     }
                 }
             }
@@ -176,13 +342,13 @@ Dfa* nfa_to_dfa(Nfa* nfa) {
                 continue;
             }
 
-            // We have a valid next state. See if we've already created
-            // a DFA state for this exact set of NFA states.
-            DfaState* target_dfa_state = find_dfa_state_by_nfa_set(next_set, next_count);
-
+            // Reuse the DFA state for this exact set of NFA states, or
+            // create it. A missing state would silently drop matches, so
+            // running out of budget (or memory) fails the whole build.
+            DfaState* target_dfa_state = find_or_create_dfa_state(next_set, next_count);
             if (target_dfa_state == NULL) {
-                // This is a new DFA state. Create it.
-                target_dfa_state = create_dfa_state(next_set, next_count);
+                failed = 1;
+                break;
             }
 
             // Create the transition in the DFA
@@ -190,18 +356,271 @@ Dfa* nfa_to_dfa(Nfa* nfa) {
         }
     }
 
-    // 4. Conversion is complete. Return the DFA graph.
-    return dfa_graph;
+    free(next_set);
+    free(set_stamps);
+    free(state_table);
+    set_stamps = NULL;
+    state_table = NULL;
+
+    // 5. Conversion is complete. Return the DFA graph.
+    Dfa* result = dfa_graph;
+    dfa_graph = NULL;
+    if (failed) {
+        *over_budget = budget_exceeded;
+        free_dfa(result);
+        return NULL;
+    }
+    return result;
+}
+
+/**
+ * @brief Converts with the default budget, reporting why a build failed.
+ */
+static Dfa* build_dfa_with_default_budget(Nfa* nfa, int unanchored) {
+    DfaBudget budget = { MAX_DFA_STATES, 0 };
+    DfaLimit over_budget = DFA_WITHIN_BUDGET;
+    Dfa* dfa = build_dfa(nfa, unanchored, &budget, &over_budget);
+    if (dfa == NULL && over_budget != DFA_WITHIN_BUDGET) {
+        fprintf(stderr, "Error: Maximum number of DFA states (%d) reached.\n", MAX_DFA_STATES);
+    }
+    return dfa;
+}
+
+
+// --- Product Construction ---
+
+// How the accepting flags of the two component DFAs are combined
+typedef enum ProductMode {
+    PRODUCT_INTERSECTION, // accept if A accepts and B accepts
+    PRODUCT_DIFFERENCE    // accept if A accepts and B does not
+} ProductMode;
+
+/**
+ * @brief Allocates an empty DfaState (no NFA set, all transitions dead)
+ * and appends it to a DFA, unless it already has max_states states.
+ */
+static DfaState* append_empty_state(Dfa* dfa, int max_states) {
+    if (dfa->num_states >= max_states) {
+        fprintf(stderr, "Error: Maximum number of DFA states (%d) reached.\n", max_states);
+        return NULL;
+    }
+    if (reserve_state_slot(dfa) != 0) {
+        return NULL;
+    }
+    DfaState* state = (DfaState*)malloc(sizeof(DfaState));
+    if (!state) {
+        perror("Failed to allocate DfaState");
+        return NULL;
+    }
+    state->id = dfa->num_states;
+    state->is_accepting = 0;
+    state->accept_id = -1;
+    state->nfa_states = NULL;
+    state->num_nfa_states = 0;
+    state->set_hash = 0;
+    memset(state->transitions, 0, sizeof(state->transitions));
+    dfa->all_states[dfa->num_states++] = state;
+    dfa->num_bytes += sizeof(DfaState);
+    return state;
+}
+
+/**
+ * @brief Removes every state that can never reach an accepting state.
+ * Transitions into such states become NULL, so simulation stops at the
+ * first character that makes a match impossible. The start state is kept
+ * even if it is dead (the DFA then matches nothing). Pruning is only an
+ * optimization, so if it cannot allocate its table it does nothing.
+ */
+static void prune_dead_states(Dfa* dfa) {
+    int* live = (int*)calloc((size_t)dfa->num_states + 1, sizeof(int));
+    if (!live) return;
+
+    // Backward fixpoint: a state is live if it accepts or steps to a live state
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < dfa->num_states; i++) {
+            DfaState* s = dfa->all_states[i];
+            if (live[i]) continue;
+            if (s->is_accepting) {
+                live[i] = 1;
+                changed = 1;
+                continue;
+            }
+            for (int c = 0; c < 256; c++) {
+                if (s->transitions[c] && live[s->transitions[c]->id]) {
+                    live[i] = 1;
+                    changed = 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Cut edges into dead states
+    for (int i = 0; i < dfa->num_states; i++) {
+        DfaState* s = dfa->all_states[i];
+        for (int c = 0; c < 256; c++) {
+            if (s->transitions[c] && !live[s->transitions[c]->id]) {
+                s->transitions[c] = NULL;
+            }
+        }
+    }
+
+    // Free dead states and renumber the survivors
+    int kept = 0;
+    for (int i = 0; i < dfa->num_states; i++) {
+        DfaState* s = dfa->all_states[i];
+        if (live[i] || s == dfa->start_state) {
+            s->id = kept;
+            dfa->all_states[kept++] = s;
+        } else {
+            dfa->num_bytes -= sizeof(DfaState);
+            free(s);
+        }
+    }
+    dfa->num_states = kept;
+    free(live);
+}
+
+/**
+ * @brief Builds the product automaton of two DFAs.
+ * Each product state is a pair (state of A, state of B); B's component may
+ * be the dead state (-1), which still matters for a difference.
+ */
+static Dfa* build_product(Dfa* a, Dfa* b, ProductMode mode) {
+    // Every pair of operand states can become one product state
+    // pair_to_state[ia * (b->num_states + 1) + (ib + 1)]: product state for (ia, ib)
+    int b_slots = b->num_states + 1;
+    size_t num_pairs = (size_t)a->num_states * b_slots;
+    int max_states = num_pairs < MAX_PRODUCT_DFA_STATES ? (int)num_pairs : MAX_PRODUCT_DFA_STATES;
+
+    Dfa* product = (Dfa*)calloc(1, sizeof(Dfa));
+    DfaState** pair_to_state = (DfaState**)calloc(num_pairs, sizeof(DfaState*));
+    int* pair_a = (int*)malloc(max_states * sizeof(int));
+    int* pair_b = (int*)malloc(max_states * sizeof(int));
+    if (!product || !pair_to_state || !pair_a || !pair_b) {
+        perror("Failed to allocate product DFA");
+        free(product);
+        free(pair_to_state);
+        free(pair_a);
+        free(pair_b);
+        return NULL;
+    }
+
+    // States are processed in creation order, so all_states is the worklist
+    product->start_state = append_empty_state(product, max_states);
+    if (product->start_state == NULL) {
+        free(pair_to_state);
+        free(pair_a);
+        free(pair_b);
+        free_dfa(product);
+        return NULL;
+    }
+    pair_a[0] = a->start_state->id;
+    pair_b[0] = b->start_state->id;
+    pair_to_state[pair_a[0] * b_slots + pair_b[0] + 1] = product->start_state;
+
+    int failed = 0;
+    for (int next = 0; next < product->num_states && !failed; next++) {
+        DfaState* current = product->all_states[next];
+        DfaState* state_a = a->all_states[pair_a[next]];
+        DfaState* state_b = pair_b[next] >= 0 ? b->all_states[pair_b[next]] : NULL;
+
+        int b_accepts = state_b != NULL && state_b->is_accepting;
+        current->is_accepting = state_a->is_accepting &&
+                                (mode == PRODUCT_INTERSECTION ? b_accepts : !b_accepts);
+
+        for (int c = 0; c < 256; c++) {
+            DfaState* target_a = state_a->transitions[c];
+            DfaState* target_b = state_b ? state_b->transitions[c] : NULL;
+
+            // A dead A side can never accept again under either mode; a
+            // dead B side only kills an intersection.
+            if (target_a == NULL) continue;
+            if (target_b == NULL && mode == PRODUCT_INTERSECTION) continue;
+
+            int ib = target_b ? target_b->id : -1;
+            DfaState** slot = &pair_to_state[target_a->id * b_slots + ib + 1];
+            if (*slot == NULL) {
+                *slot = append_empty_state(product, max_states);
+                if (*slot == NULL) {
+                    failed = 1;
+                    break;
+                }
+                pair_a[(*slot)->id] = target_a->id;
+                pair_b[(*slot)->id] = ib;
+            }
+            current->transitions[c] = *slot;
+        }
+    }
+
+    free(pair_to_state);
+    free(pair_a);
+    free(pair_b);
+
+    if (failed) {
+        free_dfa(product);
+        return NULL;
+    }
+
+    prune_dead_states(product);
+    return product;
+}
+
+
+// --- Public Functions ---
+
+Dfa* nfa_to_dfa(Nfa* nfa) {
+    return build_dfa_with_default_budget(nfa, 0);
+}
+
+Dfa* nfa_to_search_dfa(Nfa* nfa) {
+    return build_dfa_with_default_budget(nfa, 1);
+}
+
+Dfa* nfa_to_dfa_within_budget(Nfa* nfa, int unanchored, const DfaBudget* budget, DfaLimit* over_budget) {
+    return build_dfa(nfa, unanchored, budget, over_budget);
+}
+
+Dfa* dfa_intersect(Dfa* a, Dfa* b) {
+    return build_product(a, b, PRODUCT_INTERSECTION);
+}
+
+Dfa* dfa_difference(Dfa* a, Dfa* b) {
+    return build_product(a, b, PRODUCT_DIFFERENCE);
+}
+
+Dfa* dfa_complement(Dfa* dfa) {
+    // Complement = (every string) minus dfa. The "every string" DFA is a
+    // single accepting state looping on every byte except NUL.
+    Dfa universal;
+    memset(&universal, 0, sizeof(Dfa));
+    universal.start_state = append_empty_state(&universal, 1);
+    if (!universal.start_state) {
+        free(universal.all_states);
+        return NULL;
+    }
+
+    universal.start_state->is_accepting = 1;
+    for (int c = 1; c < 256; c++) {
+        universal.start_state->transitions[c] = universal.start_state;
+    }
+
+    Dfa* result = build_product(&universal, dfa, PRODUCT_DIFFERENCE);
+    free(universal.start_state);
+    free(universal.all_states);
+    return result;
 }
 
 int simulate_dfa(Dfa* dfa, const char* str) {
     DfaState* current_state = dfa->start_state;
 
     for (int i = 0; str[i] != '\0'; i++) {
-        char c = str[i];
+        unsigned char c = (unsigned char)str[i];
         
         // This is the core of DFA simulation: a simple array lookup.
-        current_state = current_state->transitions[(int)c];
+        current_state = current_state->transitions[c];
 
         // If the transition is NULL, we've gone to a "dead state".
         if (current_state == NULL) {
@@ -213,13 +632,77 @@ int simulate_dfa(Dfa* dfa, const char* str) {
     return current_state->is_accepting;
 }
 
+int search_dfa(Dfa* forward, Dfa* reverse, const char* str, int* match_start, int* match_end) {
+    // Pass 1: scan the whole string backward with the unanchored reverse
+    // DFA. Every accepting state marks a position where some match starts;
+    // the last one seen is the leftmost.
+    int length = (int)strlen(str);
+    DfaState* current_state = reverse->start_state;
+    int start = current_state->is_accepting ? length : -1;
+
+    for (int i = length - 1; i >= 0; i--) {
+        current_state = current_state->transitions[(unsigned char)str[i]];
+
+        // Only characters the pattern never uses lead nowhere. They cannot
+        // be part of a match, so everything restarts before them.
+        if (current_state == NULL) {
+            current_state = reverse->start_state;
+        }
+        if (current_state->is_accepting) {
+            start = i;
+        }
+    }
+
+    if (start < 0) {
+        return 0; // No Match anywhere in the string
+    }
+
+    // Pass 2: run the anchored forward DFA from that start. Every accepting
+    // state we pass marks a valid end; keep the rightmost (longest) one.
+    current_state = forward->start_state;
+    int end = current_state->is_accepting ? start : -1;
+
+    for (int i = start; str[i] != '\0'; i++) {
+        current_state = current_state->transitions[(unsigned char)str[i]];
+        if (current_state == NULL) {
+            break; // Dead state: the match cannot get any longer
+        }
+        if (current_state->is_accepting) {
+            end = i + 1;
+        }
+    }
+
+    *match_start = start;
+    *match_end = end;
+    return end >= 0;
+}
+
+int dfa_has_match(Dfa* forward, const char* text, size_t length) {
+    DfaState* current_state = forward->start_state;
+    if (current_state->is_accepting) {
+        return 1;
+    }
+    for (size_t i = 0; i < length; i++) {
+        current_state = current_state->transitions[(unsigned char)text[i]];
+        if (current_state == NULL) {
+            current_state = forward->start_state; // Same restart rule as nfa_to_search_dfa()
+        }
+        if (current_state->is_accepting) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 void free_dfa(Dfa* dfa) {
     if (!dfa) return;
     // Free each DfaState
     for (int i = 0; i < dfa->num_states; i++) {
+        free(dfa->all_states[i]->nfa_states);
         free(dfa->all_states[i]);
     }
-    // Free the container struct
+    // Free the state list and the container struct
+    free(dfa->all_states);
     free(dfa);
 }
 
@@ -244,9 +727,12 @@ void print_dfa(Dfa* dfa) {
         printf("}) %s\n", s->is_accepting ? "[ACCEPT]" : "");
 
         // Print transitions for this state
-        for (int c = 32; c < 127; c++) {
-            if (s->transitions[c] != NULL) {
+        for (int c = 1; c < 256; c++) {
+            if (s->transitions[c] == NULL) continue;
+            if (c >= 32 && c < 127) {
                 printf("      '%c' -> S%d\n", (char)c, s->transitions[c]->id);
+            } else {
+                printf("      '\\x%02x' -> S%d\n", c, s->transitions[c]->id);
             }
         }
     }
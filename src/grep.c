@@ -0,0 +1,510 @@
+#include "grep.h"
+#include "mapped_file.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define DEFAULT_CHUNK_SIZE (1 << 20)    // 1 MiB per chunk
+#define DEFAULT_PENDING_PER_THREAD 4    // In-flight chunks per matcher thread
+#define MAX_GREP_THREADS 64
+
+/**
+ * @struct GrepFile
+ * @brief A mapped input file, shared by all of its chunks.
+ */
+typedef struct GrepFile {
+    char* path;
+    MappedFile map;
+    long line_base;         // Lines in the chunks already written (writer only)
+} GrepFile;
+
+/**
+ * @struct GrepMatch
+ * @brief One matching line, found by a matcher thread.
+ */
+typedef struct GrepMatch {
+    long line;              // 0-based line index within the chunk
+    size_t start;           // File offset of the line's first byte
+    size_t length;          // Line length, without the '\n'
+} GrepMatch;
+
+/**
+ * @struct GrepTask
+ * @brief A chunk of a file (whole lines only) and, once scanned, its results.
+ */
+typedef struct GrepTask {
+    GrepFile* file;
+    size_t begin;           // File offset of the chunk's first byte
+    size_t end;             // File offset just past its last byte
+    int is_last_chunk;      // 1 if the writer should release the file after it
+
+    long num_lines;         // Number of '\n' in the chunk
+    GrepMatch* matches;
+    int num_matches;
+    int max_matches;
+    int done;               // Set (under the pipeline lock) once scanned
+} GrepTask;
+
+/**
+ * @struct TaskDeque
+ * @brief A matcher thread's queue of chunks.
+ * The owner takes the oldest chunk from the front, which keeps the ordered
+ * writer moving; thieves take the newest from the back, the chunk the
+ * owner would have reached last.
+ */
+typedef struct TaskDeque {
+    pthread_mutex_t lock;
+    GrepTask** tasks;       // Ring buffer
+    int capacity;
+    int head;               // Index of the front element
+    int count;
+} TaskDeque;
+
+/**
+ * @struct GrepPipeline
+ * @brief State shared by the reader, the matchers and the writer.
+ */
+typedef struct GrepPipeline {
+    const EnginePlan* plan; // Shared, read-only
+    char* const* paths;
+    int num_paths;
+    size_t chunk_size;
+
+    int num_workers;
+    TaskDeque* deques;      // One per matcher thread
+    int next_worker;        // Round-robin target for new chunks (reader only)
+
+    // Everything below is guarded by 'lock'
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;  // Matchers: a chunk was queued or the reader finished
+    pthread_cond_t task_done;   // Writer: a chunk was scanned or the reader finished
+    pthread_cond_t slot_free;   // Reader: the writer retired a chunk
+    GrepTask** window;      // In-flight chunks, indexed by sequence % max_pending
+    int max_pending;
+    long num_created;       // Sequence number of the next chunk
+    long num_written;       // Sequence number of the next chunk to write
+    int num_queued;         // Chunks sitting in deques
+    int reader_done;
+} GrepPipeline;
+
+typedef struct MatcherArgs {
+    GrepPipeline* pipeline;
+    int index;
+    NfaRun* run;            // This thread's working memory from create_plan_run() (owned)
+} MatcherArgs;
+
+// --- Task Deques ---
+
+static void deque_push_back(TaskDeque* deque, GrepTask* task) {
+    pthread_mutex_lock(&deque->lock);
+    deque->tasks[(deque->head + deque->count) % deque->capacity] = task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+static GrepTask* deque_pop_front(TaskDeque* deque) {
+    GrepTask* task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0) {
+        task = deque->tasks[deque->head];
+        deque->head = (deque->head + 1) % deque->capacity;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+static GrepTask* deque_pop_back(TaskDeque* deque) {
+    GrepTask* task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0) {
+        deque->count--;
+        task = deque->tasks[(deque->head + deque->count) % deque->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+// --- Matching ---
+
+static int add_match(GrepTask* task, long line, size_t start, size_t length) {
+    if (task->num_matches == task->max_matches) {
+        int new_max = task->max_matches ? task->max_matches * 2 : 16;
+        GrepMatch* grown = (GrepMatch*)realloc(task->matches, new_max * sizeof(GrepMatch));
+        if (!grown) {
+            perror("Failed to grow match list");
+            return -1;
+        }
+        task->matches = grown;
+        task->max_matches = new_max;
+    }
+    GrepMatch* match = &task->matches[task->num_matches++];
+    match->line = line;
+    match->start = start;
+    match->length = length;
+    return 0;
+}
+
+/**
+ * @brief Scans one chunk line by line, recording the lines that match.
+ */
+static void scan_chunk(const EnginePlan* plan, NfaRun* run, GrepTask* task) {
+    const char* data = task->file->map.data;
+    size_t line_start = task->begin;
+    long line = 0;
+
+    while (line_start < task->end) {
+        const char* newline = (const char*)memchr(data + line_start, '\n', task->end - line_start);
+        size_t line_end = newline ? (size_t)(newline - data) : task->end;
+
+        // On allocation failure the line is dropped but numbering stays right
+        if (plan_has_match(plan, run, data + line_start, line_end - line_start)) {
+            add_match(task, line, line_start, line_end - line_start);
+        }
+
+        if (newline == NULL) break;
+        line++;
+        line_start = line_end + 1;
+    }
+    task->num_lines = line;
+}
+
+static void* matcher_thread(void* arg) {
+    MatcherArgs* args = (MatcherArgs*)arg;
+    GrepPipeline* p = args->pipeline;
+
+    for (;;) {
+        // Own deque first, then try to steal from every other matcher
+        GrepTask* task = deque_pop_front(&p->deques[args->index]);
+        for (int i = 1; task == NULL && i < p->num_workers; i++) {
+            task = deque_pop_back(&p->deques[(args->index + i) % p->num_workers]);
+        }
+
+        if (task) {
+            pthread_mutex_lock(&p->lock);
+            p->num_queued--;
+            pthread_mutex_unlock(&p->lock);
+
+            scan_chunk(p->plan, args->run, task);
+
+            pthread_mutex_lock(&p->lock);
+            task->done = 1;
+            pthread_cond_signal(&p->task_done);
+            pthread_mutex_unlock(&p->lock);
+            continue;
+        }
+
+        pthread_mutex_lock(&p->lock);
+        while (p->num_queued <= 0 && !p->reader_done) {
+            pthread_cond_wait(&p->work_ready, &p->lock);
+        }
+        int finished = p->num_queued <= 0 && p->reader_done;
+        pthread_mutex_unlock(&p->lock);
+
+        if (finished) break;
+    }
+    return NULL;
+}
+
+// --- Reader Stage ---
+
+static char* copy_string(const char* str) {
+    size_t length = strlen(str);
+    char* copy = (char*)malloc(length + 1);
+    if (copy) {
+        memcpy(copy, str, length + 1);
+    }
+    return copy;
+}
+
+#ifdef _WIN32
+
+static int default_thread_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+
+#else
+
+static int default_thread_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+#endif
+
+/**
+ * @brief Hands a chunk to the matchers, blocking while the window is full.
+ */
+static void submit_task(GrepPipeline* p, GrepTask* task) {
+    pthread_mutex_lock(&p->lock);
+    while (p->num_created - p->num_written >= p->max_pending) {
+        pthread_cond_wait(&p->slot_free, &p->lock);
+    }
+    p->window[p->num_created % p->max_pending] = task;
+    p->num_created++;
+    pthread_mutex_unlock(&p->lock);
+
+    deque_push_back(&p->deques[p->next_worker], task);
+    p->next_worker = (p->next_worker + 1) % p->num_workers;
+
+    pthread_mutex_lock(&p->lock);
+    p->num_queued++;
+    pthread_cond_signal(&p->work_ready);
+    pthread_mutex_unlock(&p->lock);
+}
+
+/**
+ * @brief Maps a file and submits it as chunks that end on line boundaries.
+ */
+static void read_file(GrepPipeline* p, const char* path) {
+    GrepFile* file = (GrepFile*)calloc(1, sizeof(GrepFile));
+    if (!file) {
+        perror("Failed to allocate GrepFile");
+        return;
+    }
+    if (map_file(path, &file->map) != 0) {
+        fprintf(stderr, "Error: Cannot read '%s'.\n", path);
+        free(file);
+        return;
+    }
+    if (file->map.length == 0) {
+        unmap_file(&file->map); // Nothing to search
+        free(file);
+        return;
+    }
+    file->path = copy_string(path);
+
+    const char* data = file->map.data;
+    size_t length = file->map.length;
+    size_t begin = 0;
+
+    // Each chunk is submitted once the next one exists, so that whichever
+    // task goes out last can be marked as releasing the file
+    GrepTask* held = NULL;
+    while (begin < length) {
+        size_t end = length;
+        if (length - begin > p->chunk_size) {
+            const char* newline = (const char*)memchr(data + begin + p->chunk_size, '\n',
+                                                      length - begin - p->chunk_size);
+            if (newline) end = (size_t)(newline - data) + 1;
+        }
+
+        GrepTask* task = (GrepTask*)calloc(1, sizeof(GrepTask));
+        if (!task) {
+            perror("Failed to allocate GrepTask");
+            break; // Give up on the rest of the file
+        }
+        task->file = file;
+        task->begin = begin;
+        task->end = end;
+        if (held) {
+            submit_task(p, held);
+        }
+        held = task;
+        begin = end;
+    }
+
+    if (!held) {
+        // No chunk went out, so no writer will ever release the file
+        unmap_file(&file->map);
+        free(file->path);
+        free(file);
+        return;
+    }
+    held->is_last_chunk = 1;
+    submit_task(p, held);
+}
+
+static void read_path(GrepPipeline* p, const char* path) {
+    if (!is_directory(path)) {
+        read_file(p, path);
+        return;
+    }
+
+    char** names = NULL;
+    int num_names = 0;
+    if (list_directory(path, &names, &num_names) != 0) {
+        fprintf(stderr, "Error: Cannot list directory '%s'.\n", path);
+        return;
+    }
+
+    for (int i = 0; i < num_names; i++) {
+        char* child = join_path(path, names[i]);
+        if (child) {
+            read_path(p, child);
+            free(child);
+        }
+        free(names[i]);
+    }
+    free(names);
+}
+
+static void* reader_thread(void* arg) {
+    GrepPipeline* p = (GrepPipeline*)arg;
+
+    for (int i = 0; i < p->num_paths; i++) {
+        read_path(p, p->paths[i]);
+    }
+
+    pthread_mutex_lock(&p->lock);
+    p->reader_done = 1;
+    pthread_cond_broadcast(&p->work_ready);
+    pthread_cond_signal(&p->task_done);
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+// --- Writer Stage ---
+
+/**
+ * @brief Writes scanned chunks strictly in sequence order, then frees them.
+ * @return The number of matching lines written.
+ */
+static long write_results(GrepPipeline* p, FILE* out) {
+    long total = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        for (;;) {
+            if (p->num_written < p->num_created &&
+                p->window[p->num_written % p->max_pending]->done) {
+                break;
+            }
+            if (p->reader_done && p->num_written == p->num_created) {
+                pthread_mutex_unlock(&p->lock);
+                return total;
+            }
+            pthread_cond_wait(&p->task_done, &p->lock);
+        }
+        GrepTask* task = p->window[p->num_written % p->max_pending];
+        pthread_mutex_unlock(&p->lock);
+
+        GrepFile* file = task->file;
+        for (int i = 0; i < task->num_matches; i++) {
+            GrepMatch* match = &task->matches[i];
+            fprintf(out, "%s:%ld:", file->path, file->line_base + match->line + 1);
+            fwrite(file->map.data + match->start, 1, match->length, out);
+            fputc('\n', out);
+        }
+        total += task->num_matches;
+        file->line_base += task->num_lines;
+
+        if (task->is_last_chunk) {
+            unmap_file(&file->map);
+            free(file->path);
+            free(file);
+        }
+        free(task->matches);
+        free(task);
+
+        pthread_mutex_lock(&p->lock);
+        p->num_written++;
+        pthread_cond_signal(&p->slot_free);
+        pthread_mutex_unlock(&p->lock);
+    }
+}
+
+// --- Public Function ---
+
+long grep_paths(const EnginePlan* plan, char* const* paths, int num_paths,
+                const GrepOptions* options, FILE* out) {
+    GrepPipeline p;
+    memset(&p, 0, sizeof(p));
+    p.plan = plan;
+    p.paths = paths;
+    p.num_paths = num_paths;
+
+    int num_threads = options ? options->num_threads : 0;
+    if (num_threads <= 0) num_threads = default_thread_count();
+    if (num_threads > MAX_GREP_THREADS) num_threads = MAX_GREP_THREADS;
+
+    p.chunk_size = (options && options->chunk_size > 0) ? options->chunk_size : DEFAULT_CHUNK_SIZE;
+    p.max_pending = (options && options->max_pending > 0) ? options->max_pending
+                                                          : num_threads * DEFAULT_PENDING_PER_THREAD;
+
+    p.window = (GrepTask**)calloc(p.max_pending, sizeof(GrepTask*));
+    p.deques = (TaskDeque*)calloc(num_threads, sizeof(TaskDeque));
+    MatcherArgs* args = (MatcherArgs*)calloc(num_threads, sizeof(MatcherArgs));
+    pthread_t* workers = (pthread_t*)calloc(num_threads, sizeof(pthread_t));
+    if (!p.window || !p.deques || !args || !workers) {
+        perror("Failed to allocate grep pipeline");
+        free(p.window);
+        free(p.deques);
+        free(args);
+        free(workers);
+        return -1;
+    }
+
+    pthread_mutex_init(&p.lock, NULL);
+    pthread_cond_init(&p.work_ready, NULL);
+    pthread_cond_init(&p.task_done, NULL);
+    pthread_cond_init(&p.slot_free, NULL);
+
+    // A deque never holds more than the whole window, so it can't overflow
+    int num_deques = 0;
+    for (; num_deques < num_threads; num_deques++) {
+        TaskDeque* deque = &p.deques[num_deques];
+        deque->tasks = (GrepTask**)malloc(p.max_pending * sizeof(GrepTask*));
+        if (!deque->tasks) break;
+        deque->capacity = p.max_pending;
+        pthread_mutex_init(&deque->lock, NULL);
+    }
+
+    // If fewer threads start than there are deques, the running matchers
+    // steal the orphaned deques' chunks, so a short pool still finishes.
+    // Each thread keeps its own NFA working memory for every chunk it scans.
+    p.num_workers = num_deques;
+    int num_started = 0;
+    for (; num_started < p.num_workers; num_started++) {
+        args[num_started].pipeline = &p;
+        args[num_started].index = num_started;
+        args[num_started].run = create_plan_run(p.plan);
+        if (args[num_started].run == NULL && plan_needs_run(p.plan)) {
+            break;
+        }
+        if (pthread_create(&workers[num_started], NULL, matcher_thread, &args[num_started]) != 0) {
+            free_nfa_run(args[num_started].run);
+            break;
+        }
+    }
+
+    long total = -1;
+    pthread_t reader;
+    if (num_started > 0 && pthread_create(&reader, NULL, reader_thread, &p) == 0) {
+        total = write_results(&p, out);
+        pthread_join(reader, NULL);
+    } else {
+        fprintf(stderr, "Error: Failed to start grep threads.\n");
+        pthread_mutex_lock(&p.lock);
+        p.reader_done = 1;
+        pthread_cond_broadcast(&p.work_ready);
+        pthread_mutex_unlock(&p.lock);
+    }
+
+    for (int i = 0; i < num_started; i++) {
+        pthread_join(workers[i], NULL);
+        free_nfa_run(args[i].run);
+    }
+
+    for (int i = 0; i < num_deques; i++) {
+        pthread_mutex_destroy(&p.deques[i].lock);
+        free(p.deques[i].tasks);
+    }
+    pthread_cond_destroy(&p.slot_free);
+    pthread_cond_destroy(&p.task_done);
+    pthread_cond_destroy(&p.work_ready);
+    pthread_mutex_destroy(&p.lock);
+    free(p.window);
+    free(p.deques);
+    free(args);
+    free(workers);
+    return total;
+}
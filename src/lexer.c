@@ -0,0 +1,202 @@
+#include "lexer.h"
+#include "parser.h"
+#include "regex_ast.h"
+#include "nfa.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @struct TokenRule
+ * @brief One entry of the token table: a token type and its regex.
+ */
+typedef struct TokenRule {
+    TokenType type;
+    const char* pattern;
+    int skip;           // 1 if the lexer consumes these tokens silently
+} TokenRule;
+
+// The token table, in priority order: when two rules match the same
+// (longest) lexeme, the earlier one wins. That is how "var" becomes
+// TOKEN_VAR rather than TOKEN_ID.
+static const TokenRule token_rules[] = {
+    { TOKEN_WHITESPACE, "[ \\t\\r\\n][ \\t\\r\\n]*", 1 },
+    { TOKEN_COMMENT,    "\\/\\/[^\\n]*",             1 },
+    { TOKEN_VAR,        "var",                       0 },
+    { TOKEN_PRINT,      "print",                     0 },
+    { TOKEN_ID,         "[a-zA-Z_][a-zA-Z0-9_]*",    0 },
+    { TOKEN_INT,        "[0-9][0-9]*",               0 },
+    { TOKEN_PLUS,       "\\+",                       0 },
+    { TOKEN_MINUS,      "\\-",                       0 },
+    { TOKEN_STAR,       "\\*",                       0 },
+    { TOKEN_SLASH,      "\\/",                       0 },
+    { TOKEN_ASSIGN,     "\\=",                       0 },
+    { TOKEN_SEMICOLON,  "\\;",                       0 },
+    { TOKEN_LPAREN,     "\\(",                       0 },
+    { TOKEN_RPAREN,     "\\)",                       0 },
+};
+
+#define NUM_TOKEN_RULES ((int)(sizeof(token_rules) / sizeof(token_rules[0])))
+
+/**
+ * @brief Runs one token pattern through the same pipeline as the CLI
+ * (preprocess, postfix, syntax tree rewrites) and builds its NFA.
+ */
+static Nfa* compile_rule(const char* pattern) {
+    int size = 2 * (int)strlen(pattern) + 2;
+    char* preprocessed = (char*)malloc(size);
+    char* postfix = (char*)malloc(size);
+    char* optimized = (char*)malloc(2 * size);
+    Nfa* nfa = NULL;
+
+    if (preprocessed && postfix && optimized) {
+        preprocess_regex(pattern, preprocessed, size);
+        if (regex_to_postfix(preprocessed, postfix, size) == 0) {
+            const char* final_postfix = postfix;
+            RegexNode* ast = build_ast_from_postfix(postfix);
+            if (ast) {
+                ast = optimize_ast(ast);
+                if (ast_to_postfix(ast, optimized, 2 * size) == 0) {
+                    final_postfix = optimized;
+                }
+                free_ast(ast);
+            }
+            nfa = build_glushkov_nfa_from_postfix(final_postfix);
+        }
+    } else {
+        perror("Failed to allocate token pattern buffers");
+    }
+
+    free(preprocessed);
+    free(postfix);
+    free(optimized);
+    return nfa;
+}
+
+// --- Public Functions ---
+
+Dfa* build_lexer_dfa(void) {
+    Nfa* rule_nfas[NUM_TOKEN_RULES];
+
+    for (int i = 0; i < NUM_TOKEN_RULES; i++) {
+        rule_nfas[i] = compile_rule(token_rules[i].pattern);
+        if (rule_nfas[i] == NULL) {
+            fprintf(stderr, "Error: Failed to compile token pattern '%s'.\n",
+                    token_rules[i].pattern);
+            for (int j = 0; j < i; j++) free_nfa(rule_nfas[j]);
+            return NULL;
+        }
+    }
+
+    // One NFA for the whole table; accepting states are tagged with
+    // their rule index, and the DFA keeps the lowest tag per state.
+    Nfa* combined = build_tagged_union_nfa(rule_nfas, NUM_TOKEN_RULES);
+    if (combined == NULL) {
+        for (int i = 0; i < NUM_TOKEN_RULES; i++) free_nfa(rule_nfas[i]);
+        return NULL;
+    }
+
+    Dfa* dfa = nfa_to_dfa(combined);
+    free_nfa(combined);
+    return dfa;
+}
+
+void lexer_init(Lexer* lexer, Dfa* dfa, const char* source, size_t length) {
+    lexer->source = source;
+    lexer->length = length;
+    lexer->position = 0;
+    lexer->line = 1;
+    lexer->dfa = dfa;
+    lexer->file.data = "";
+    lexer->file.length = 0;
+    lexer->file.handle = NULL;
+}
+
+int lexer_open_file(Lexer* lexer, Dfa* dfa, const char* path) {
+    MappedFile file;
+    if (map_file(path, &file) != 0) {
+        return -1;
+    }
+    lexer_init(lexer, dfa, file.data, file.length);
+    lexer->file = file;
+    return 0;
+}
+
+Token get_next_token(Lexer* lexer) {
+    for (;;) {
+        Token token;
+        token.offset = lexer->position;
+        token.line = lexer->line;
+
+        if (lexer->position >= lexer->length) {
+            token.type = TOKEN_EOF;
+            token.length = 0;
+            return token;
+        }
+
+        // Maximal munch: follow the DFA until it dies, remembering the
+        // last position where it was in an accepting state.
+        DfaState* state = lexer->dfa->start_state;
+        int accept_id = -1;
+        size_t accept_length = 0;
+
+        for (size_t i = lexer->position; i < lexer->length; i++) {
+            state = state->transitions[(unsigned char)lexer->source[i]];
+            if (state == NULL) break;
+
+            if (state->accept_id >= 0) {
+                accept_id = state->accept_id;
+                accept_length = i + 1 - lexer->position;
+            }
+        }
+
+        if (accept_id < 0) {
+            // No rule matches here: report one bad character and move on
+            token.type = TOKEN_ERROR;
+            token.length = 1;
+        } else {
+            token.type = token_rules[accept_id].type;
+            token.length = accept_length;
+        }
+
+        // Only whitespace and comments can span lines
+        for (size_t i = 0; i < token.length; i++) {
+            if (lexer->source[token.offset + i] == '\n') lexer->line++;
+        }
+        lexer->position += token.length;
+
+        if (accept_id >= 0 && token_rules[accept_id].skip) {
+            continue;
+        }
+        return token;
+    }
+}
+
+const char* token_type_name(TokenType type) {
+    switch (type) {
+        case TOKEN_VAR:        return "TOKEN_VAR";
+        case TOKEN_PRINT:      return "TOKEN_PRINT";
+        case TOKEN_ID:         return "TOKEN_ID";
+        case TOKEN_INT:        return "TOKEN_INT";
+        case TOKEN_PLUS:       return "TOKEN_PLUS";
+        case TOKEN_MINUS:      return "TOKEN_MINUS";
+        case TOKEN_STAR:       return "TOKEN_STAR";
+        case TOKEN_SLASH:      return "TOKEN_SLASH";
+        case TOKEN_ASSIGN:     return "TOKEN_ASSIGN";
+        case TOKEN_SEMICOLON:  return "TOKEN_SEMICOLON";
+        case TOKEN_LPAREN:     return "TOKEN_LPAREN";
+        case TOKEN_RPAREN:     return "TOKEN_RPAREN";
+        case TOKEN_WHITESPACE: return "TOKEN_WHITESPACE";
+        case TOKEN_COMMENT:    return "TOKEN_COMMENT";
+        case TOKEN_ERROR:      return "TOKEN_ERROR";
+        case TOKEN_EOF:        return "TOKEN_EOF";
+    }
+    return "TOKEN_UNKNOWN";
+}
+
+void lexer_close(Lexer* lexer) {
+    unmap_file(&lexer->file);
+    lexer->source = "";
+    lexer->length = 0;
+    lexer->position = 0;
+}
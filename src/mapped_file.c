@@ -0,0 +1,200 @@
+#include "mapped_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static int add_name(char*** names, int* count, int* max_names, const char* name) {
+    if (*count == *max_names) {
+        int new_max = *max_names ? *max_names * 2 : 16;
+        char** grown = (char**)realloc(*names, new_max * sizeof(char*));
+        if (!grown) {
+            perror("Failed to grow directory listing");
+            return -1;
+        }
+        *names = grown;
+        *max_names = new_max;
+    }
+    size_t length = strlen(name);
+    char* copy = (char*)malloc(length + 1);
+    if (!copy) {
+        perror("Failed to copy file name");
+        return -1;
+    }
+    memcpy(copy, name, length + 1);
+    (*names)[(*count)++] = copy;
+    return 0;
+}
+
+char* join_path(const char* directory, const char* name) {
+    size_t length = strlen(directory) + strlen(name) + 2;
+    char* path = (char*)malloc(length);
+    if (!path) {
+        perror("Failed to allocate path");
+        return NULL;
+    }
+    snprintf(path, length, "%s%c%s", directory, PATH_SEPARATOR, name);
+    return path;
+}
+
+#ifdef _WIN32
+
+int map_file(const char* path, MappedFile* file) {
+    file->data = "";
+    file->length = 0;
+    file->handle = NULL;
+
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return -1;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(handle);
+        return 0; // Nothing to map; an empty view is still a valid file
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle); // The mapping keeps the file open
+    if (mapping == NULL) {
+        return -1;
+    }
+
+    const char* view = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        return -1;
+    }
+
+    file->data = view;
+    file->length = (size_t)size.QuadPart;
+    file->handle = mapping;
+    return 0;
+}
+
+void unmap_file(MappedFile* file) {
+    if (file->handle != NULL) {
+        UnmapViewOfFile(file->data);
+        CloseHandle((HANDLE)file->handle);
+    }
+    file->data = "";
+    file->length = 0;
+    file->handle = NULL;
+}
+
+int is_directory(const char* path) {
+    DWORD attributes = GetFileAttributesA(path);
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+int list_directory(const char* path, char*** names, int* count) {
+    char pattern[MAX_PATH];
+    snprintf(pattern, sizeof(pattern), "%s\\*", path);
+
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    if (find == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+
+    *names = NULL;
+    *count = 0;
+    int max_names = 0;
+    do {
+        if (strcmp(entry.cFileName, ".") == 0 || strcmp(entry.cFileName, "..") == 0) continue;
+        if (add_name(names, count, &max_names, entry.cFileName) != 0) break;
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+
+    qsort(*names, *count, sizeof(char*), compare_names);
+    return 0;
+}
+
+#else
+
+int map_file(const char* path, MappedFile* file) {
+    file->data = "";
+    file->length = 0;
+    file->handle = NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return 0; // mmap() rejects empty files; an empty view is still valid
+    }
+
+    void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (view == MAP_FAILED) {
+        return -1;
+    }
+
+    file->data = (const char*)view;
+    file->length = (size_t)info.st_size;
+    file->handle = view;
+    return 0;
+}
+
+void unmap_file(MappedFile* file) {
+    if (file->handle != NULL) {
+        munmap(file->handle, file->length);
+    }
+    file->data = "";
+    file->length = 0;
+    file->handle = NULL;
+}
+
+int is_directory(const char* path) {
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+int list_directory(const char* path, char*** names, int* count) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    *names = NULL;
+    *count = 0;
+    int max_names = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        if (add_name(names, count, &max_names, entry->d_name) != 0) break;
+    }
+    closedir(dir);
+
+    qsort(*names, *count, sizeof(char*), compare_names);
+    return 0;
+}
+
+#endif
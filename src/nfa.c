@@ -1,7 +1,8 @@
 #include "nfa.h"
+#include "parser.h"
 #include <stdlib.h>
 #include <stdio.h>
-#include <ctype.h>
+#include <string.h>
 
 // A global counter to give each state a unique ID.
 static int state_id_counter = 0;
@@ -16,9 +17,10 @@ static State* create_state() {
 
     state->id = state_id_counter++;
     state->num_transitions = 0;
+    state->max_transitions = 0;
     state->is_accepting = 0;
-    state->transitions[0] = NULL;
-    state->transitions[1] = NULL;
+    state->accept_id = -1;
+    state->transitions = NULL;
     return state;
 }
 
@@ -27,34 +29,64 @@ static State* create_state() {
  * @param from_state The source state.
  * @param to_state The target state.
  * @param trigger The character for the transition ('\0' for epsilon).
+ * @return 0 on success, -1 if the transition could not be allocated.
  */
-static void add_transition(State* from_state, State* to_state, char trigger) {
-    if (from_state->num_transitions >= 2) {
-        // According to Thompson's construction, a state should have at most two transitions.
-        fprintf(stderr, "Error: Exceeded max transitions for a state.\n");
-        return;
+static int add_transition(State* from_state, State* to_state, char trigger) {
+    if (from_state->num_transitions >= from_state->max_transitions) {
+        // Thompson states never need more than two slots; Glushkov states
+        // keep doubling as more follow positions are linked in.
+        int capacity = from_state->max_transitions ? from_state->max_transitions * 2 : 2;
+        Transition** grown = (Transition**)realloc(from_state->transitions,
+                                                   capacity * sizeof(Transition*));
+        if (!grown) {
+            fprintf(stderr, "Error: Failed to grow transitions for a state.\n");
+            return -1;
+        }
+        from_state->transitions = grown;
+        from_state->max_transitions = capacity;
     }
     Transition* t = (Transition*)malloc(sizeof(Transition));
-    if (!t) return;
+    if (!t) return -1;
 
     t->trigger_char = trigger;
     t->target_state = to_state;
     from_state->transitions[from_state->num_transitions++] = t;
+    return 0;
+}
+
+/**
+ * @brief Adds the transitions for one operand (a, \*, [a-z], ...).
+ * A plain character is a single edge; an escape or class gets one
+ * parallel edge per byte it matches.
+ * @param operand Pointer to the operand inside the postfix string.
+ * @return 0 on success, -1 if a transition could not be allocated.
+ */
+static int add_operand_transitions(State* from_state, State* to_state, const char* operand) {
+    if (regex_operand_length(operand) == 1) {
+        return add_transition(from_state, to_state, operand[0]);
+    }
+
+    unsigned char set[256];
+    regex_operand_chars(operand, set);
+    for (int c = 1; c < 256; c++) {
+        if (set[c] && add_transition(from_state, to_state, (char)c) != 0) return -1;
+    }
+    return 0;
 }
 
 /**
- * @brief Creates a new NFA fragment for a single character.
+ * @brief Creates a new NFA fragment for a single operand.
  * Visual: (start) --c--> (end)
- * @param c The character for the transition.
+ * @param operand Pointer to the operand (a character, escape or class).
  * @return A pointer to the newly created Nfa fragment.
  */
-static Nfa* create_nfa_for_char(char c) {
+static Nfa* create_nfa_for_char(const char* operand) {
     Nfa* nfa = (Nfa*)malloc(sizeof(Nfa));
     if (!nfa) return NULL;
 
     nfa->start = create_state();
     nfa->end = create_state();
-    add_transition(nfa->start, nfa->end, c);
+    add_operand_transitions(nfa->start, nfa->end, operand);
     return nfa;
 }
 
@@ -145,15 +177,22 @@ static Nfa* create_nfa_for_star(Nfa* nfa) {
  * It uses a stack-based approach.
  */
 Nfa* build_nfa_from_postfix(const char* postfix) {
-    Nfa* nfa_stack[1024]; // A simple stack for NFA fragments
+    // A stack for NFA fragments; there are never more than operands
+    Nfa** nfa_stack = (Nfa**)malloc((strlen(postfix) + 1) * sizeof(Nfa*));
+    if (!nfa_stack) {
+        perror("Failed to allocate NFA stack");
+        return NULL;
+    }
     int stack_top = -1;
 
     for (int i = 0; postfix[i] != '\0'; i++) {
         char token = postfix[i];
+        int length = regex_operand_length(&postfix[i]);
 
-        if (isalnum(token)) {
+        if (length > 0) {
             // If it's an operand, create a simple NFA for it and push to stack
-            nfa_stack[++stack_top] = create_nfa_for_char(token);
+            nfa_stack[++stack_top] = create_nfa_for_char(&postfix[i]);
+            i += length - 1;
         } else if (token == '.') {
             // Concatenation: pop two, combine, push result
             Nfa* nfa2 = nfa_stack[stack_top--];
@@ -173,20 +212,470 @@ Nfa* build_nfa_from_postfix(const char* postfix) {
 
     if (stack_top != 0) {
         fprintf(stderr, "Error: NFA stack should have exactly one item at the end.\n");
+        free(nfa_stack);
         return NULL;
     }
 
     // The final NFA is the only item left on the stack.
     Nfa* final_nfa = nfa_stack[stack_top--];
+    free(nfa_stack);
     // Mark its end state as the one and only accepting state.
     final_nfa->end->is_accepting = 1;
+    final_nfa->is_epsilon_free = 0;
     return final_nfa;
 }
 
-// TODO: Implement free_nfa to prevent memory leaks
+/**
+ * @struct PositionFragment
+ * @brief The Glushkov summary of a sub-expression: which positions can
+ * start it, which can end it, and whether it matches the empty string.
+ * Positions are indices into the builder's 'positions' array.
+ */
+typedef struct PositionFragment {
+    int* first;
+    int num_first;
+    int* last;
+    int num_last;
+    int nullable;
+} PositionFragment;
+
+/**
+ * @brief Concatenates two position lists into a new malloc'd list.
+ */
+static int* merge_positions(const int* a, int num_a, const int* b, int num_b) {
+    int* merged = (int*)malloc((num_a + num_b + 1) * sizeof(int));
+    if (!merged) return NULL;
+    for (int i = 0; i < num_a; i++) merged[i] = a[i];
+    for (int i = 0; i < num_b; i++) merged[num_a + i] = b[i];
+    return merged;
+}
+
+/**
+ * @brief Links every position in 'from' to every position in 'to'.
+ * A transition into a position is always labelled with that position's
+ * operand, so any existing edge to the same target means it is linked.
+ * @return 0 on success, -1 if a transition could not be allocated.
+ */
+static int link_positions(State** positions, const char** labels,
+                           const int* from, int num_from, const int* to, int num_to) {
+    for (int i = 0; i < num_from; i++) {
+        State* source = positions[from[i]];
+        for (int j = 0; j < num_to; j++) {
+            State* target = positions[to[j]];
+
+            int exists = 0;
+            for (int k = 0; k < source->num_transitions; k++) {
+                if (source->transitions[k]->target_state == target) {
+                    exists = 1;
+                    break;
+                }
+            }
+            if (!exists && add_operand_transitions(source, target, labels[to[j]]) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void free_position_fragment(PositionFragment* fragment) {
+    free(fragment->first);
+    free(fragment->last);
+}
+
+/**
+ * @brief Builds an epsilon-free NFA using Glushkov's construction.
+ * Like Thompson's construction it walks the postfix string with a stack,
+ * but the stack holds first/last position sets instead of state pairs, and
+ * concatenation and star add direct character edges between positions.
+ */
+Nfa* build_glushkov_nfa_from_postfix(const char* postfix) {
+    int length = 0;
+    while (postfix[length] != '\0') length++;
+
+    // One state per literal; there can never be more than 'length' of them
+    State** positions = (State**)malloc((length + 1) * sizeof(State*));
+    const char** labels = (const char**)malloc((length + 1) * sizeof(const char*));
+    PositionFragment* stack = (PositionFragment*)malloc((length + 1) * sizeof(PositionFragment));
+    Nfa* nfa = (Nfa*)malloc(sizeof(Nfa));
+    if (!positions || !labels || !stack || !nfa) {
+        free(positions);
+        free(labels);
+        free(stack);
+        free(nfa);
+        return NULL;
+    }
+
+    int num_positions = 0;
+    int stack_top = -1;
+    nfa->start = create_state();
+    nfa->end = NULL;
+    nfa->is_epsilon_free = 1;
+    int failed = nfa->start == NULL;
+
+    for (int i = 0; postfix[i] != '\0' && !failed; i++) {
+        char token = postfix[i];
+        int operand_length = regex_operand_length(&postfix[i]);
+
+        if (operand_length > 0) {
+            // Operand: a new position that is its own first and last set
+            State* position = create_state();
+            if (!position) {
+                failed = 1;
+                break;
+            }
+            int p = num_positions++;
+            positions[p] = position;
+            labels[p] = &postfix[i];
+            i += operand_length - 1;
+
+            PositionFragment* f = &stack[++stack_top];
+            f->first = merge_positions(&p, 1, NULL, 0);
+            f->num_first = 1;
+            f->last = merge_positions(&p, 1, NULL, 0);
+            f->num_last = 1;
+            f->nullable = 0;
+            failed = !f->first || !f->last;
+        } else if ((token == '.' || token == '|') && stack_top >= 1) {
+            PositionFragment f2 = stack[stack_top--];
+            PositionFragment f1 = stack[stack_top--];
+            PositionFragment result;
+
+            if (token == '.') {
+                // Concatenation: every way of ending f1 can continue into f2
+                failed = link_positions(positions, labels, f1.last, f1.num_last,
+                                        f2.first, f2.num_first) != 0;
+                result.first = merge_positions(f1.first, f1.num_first,
+                                               f2.first, f1.nullable ? f2.num_first : 0);
+                result.num_first = f1.num_first + (f1.nullable ? f2.num_first : 0);
+                result.last = merge_positions(f1.last, f2.nullable ? f1.num_last : 0,
+                                              f2.last, f2.num_last);
+                result.num_last = (f2.nullable ? f1.num_last : 0) + f2.num_last;
+                result.nullable = f1.nullable && f2.nullable;
+            } else {
+                // Union: either side may start or end the match
+                result.first = merge_positions(f1.first, f1.num_first, f2.first, f2.num_first);
+                result.num_first = f1.num_first + f2.num_first;
+                result.last = merge_positions(f1.last, f1.num_last, f2.last, f2.num_last);
+                result.num_last = f1.num_last + f2.num_last;
+                result.nullable = f1.nullable || f2.nullable;
+            }
+
+            free_position_fragment(&f1);
+            free_position_fragment(&f2);
+            stack[++stack_top] = result;
+            failed = failed || !result.first || !result.last;
+        } else if (token == '*' && stack_top >= 0) {
+            // Star: every way of ending the fragment can loop back to its start
+            PositionFragment* f = &stack[stack_top];
+            failed = link_positions(positions, labels, f->last, f->num_last,
+                                    f->first, f->num_first) != 0;
+            f->nullable = 1;
+        }
+    }
+
+    // The start state steps into every first position
+    if (!failed && stack_top == 0) {
+        PositionFragment* whole = &stack[0];
+        for (int i = 0; i < whole->num_first && !failed; i++) {
+            failed = add_operand_transitions(nfa->start, positions[whole->first[i]],
+                                             labels[whole->first[i]]) != 0;
+        }
+    }
+
+    if (failed || stack_top != 0) {
+        if (failed) {
+            perror("Failed to allocate Glushkov NFA");
+        } else {
+            fprintf(stderr, "Error: Glushkov stack should have exactly one item at the end.\n");
+        }
+        while (stack_top > -1) free_position_fragment(&stack[stack_top--]);
+        // The start may not reach every position, so free them directly
+        positions[num_positions++] = nfa->start;
+        for (int i = 0; i < num_positions; i++) {
+            if (!positions[i]) continue;
+            for (int j = 0; j < positions[i]->num_transitions; j++) {
+                free(positions[i]->transitions[j]);
+            }
+            free(positions[i]->transitions);
+            free(positions[i]);
+        }
+        free(positions);
+        free(labels);
+        free(stack);
+        free(nfa);
+        return NULL;
+    }
+
+    // Accepting states are the last positions (plus the start if the
+    // regex is nullable).
+    PositionFragment* whole = &stack[0];
+    for (int i = 0; i < whole->num_last; i++) {
+        positions[whole->last[i]]->is_accepting = 1;
+    }
+    nfa->start->is_accepting = whole->nullable;
+
+    free_position_fragment(whole);
+    free(positions);
+    free(labels);
+    free(stack);
+    return nfa;
+}
+
+/**
+ * @brief Inserts a state into an open-addressing set of state pointers.
+ * @return 1 if it was inserted, 0 if it was already present.
+ */
+static int insert_seen(State** slots, size_t mask, State* state) {
+    size_t i = ((size_t)state >> 4) * 2654435761u & mask;
+    while (slots[i] != NULL) {
+        if (slots[i] == state) return 0;
+        i = (i + 1) & mask;
+    }
+    slots[i] = state;
+    return 1;
+}
+
+/**
+ * @brief Collects every state reachable from the NFA's start state.
+ * Uses an explicit DFS stack, so deep NFAs cannot overflow the C stack,
+ * and a hash set of visited states, so large NFAs take linear time.
+ * @param nfa The NFA to traverse.
+ * @param out_count Receives the number of states found.
+ * @return A malloc'd array of state pointers (caller frees), or NULL on failure.
+ */
+static State** collect_states(Nfa* nfa, int* out_count) {
+    int capacity = 64;
+    int count = 0;
+    int stack_capacity = 64;
+    int stack_top = -1;
+    size_t seen_mask = 127; // Kept at most half full
+    State** states = (State**)malloc(capacity * sizeof(State*));
+    State** stack = (State**)malloc(stack_capacity * sizeof(State*));
+    State** seen = (State**)calloc(seen_mask + 1, sizeof(State*));
+    if (!states || !stack || !seen) {
+        free(states);
+        free(stack);
+        free(seen);
+        return NULL;
+    }
+
+    stack[++stack_top] = nfa->start;
+    while (stack_top > -1) {
+        State* state = stack[stack_top--];
+
+        // Skip states we have already recorded
+        if (!insert_seen(seen, seen_mask, state)) continue;
+
+        if (count >= capacity) {
+            capacity *= 2;
+            State** grown = (State**)realloc(states, capacity * sizeof(State*));
+            if (!grown) {
+                free(states);
+                free(stack);
+                free(seen);
+                return NULL;
+            }
+            states = grown;
+        }
+        states[count++] = state;
+
+        // Grow the visited set before it gets crowded
+        if ((size_t)count * 2 > seen_mask) {
+            size_t new_mask = seen_mask * 2 + 1;
+            State** grown = (State**)calloc(new_mask + 1, sizeof(State*));
+            if (!grown) {
+                free(states);
+                free(stack);
+                free(seen);
+                return NULL;
+            }
+            for (int i = 0; i < count; i++) {
+                insert_seen(grown, new_mask, states[i]);
+            }
+            free(seen);
+            seen = grown;
+            seen_mask = new_mask;
+        }
+
+        // Push every successor so it gets visited later
+        if (stack_top + 1 + state->num_transitions > stack_capacity) {
+            stack_capacity = (stack_top + 1 + state->num_transitions) * 2;
+            State** grown = (State**)realloc(stack, stack_capacity * sizeof(State*));
+            if (!grown) {
+                free(states);
+                free(stack);
+                free(seen);
+                return NULL;
+            }
+            stack = grown;
+        }
+        for (int i = 0; i < state->num_transitions; i++) {
+            stack[++stack_top] = state->transitions[i]->target_state;
+        }
+    }
+
+    free(stack);
+    free(seen);
+    *out_count = count;
+    return states;
+}
+
+/**
+ * @brief Frees the states of a partially built reverse_nfa() copy.
+ * @param copies Map from original state ID (minus min_id) to its copy; NULL slots are skipped.
+ * @param size Number of slots in the map.
+ */
+static void free_state_copies(State** copies, int size) {
+    for (int i = 0; i < size; i++) {
+        if (!copies[i]) continue;
+        for (int j = 0; j < copies[i]->num_transitions; j++) {
+            free(copies[i]->transitions[j]);
+        }
+        free(copies[i]->transitions);
+        free(copies[i]);
+    }
+    free(copies);
+}
+
+/**
+ * @brief Builds the reverse of an NFA: every edge is flipped, the old
+ * accepting state becomes the start and the old start becomes accepting.
+ * The reversed machine accepts exactly the reversed strings of the original.
+ */
+Nfa* reverse_nfa(Nfa* nfa) {
+    int count = 0;
+    State** states = collect_states(nfa, &count);
+    if (!states) return NULL;
+
+    // State IDs come from a global counter, so the IDs of one NFA form a
+    // compact range. Use it to map each original state to its copy.
+    int min_id = states[0]->id;
+    int max_id = states[0]->id;
+    for (int i = 1; i < count; i++) {
+        if (states[i]->id < min_id) min_id = states[i]->id;
+        if (states[i]->id > max_id) max_id = states[i]->id;
+    }
+
+    State** copies = (State**)calloc(max_id - min_id + 1, sizeof(State*));
+    Nfa* reversed = (Nfa*)malloc(sizeof(Nfa));
+    if (!copies || !reversed) {
+        free(states);
+        free(copies);
+        free(reversed);
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        copies[states[i]->id - min_id] = create_state();
+        if (!copies[states[i]->id - min_id]) {
+            free_state_copies(copies, max_id - min_id + 1);
+            free(states);
+            free(reversed);
+            return NULL;
+        }
+    }
+
+    // Flip every edge: (from --c--> to) becomes (to' --c--> from')
+    for (int i = 0; i < count; i++) {
+        State* from = states[i];
+        for (int j = 0; j < from->num_transitions; j++) {
+            Transition* t = from->transitions[j];
+            add_transition(copies[t->target_state->id - min_id],
+                           copies[from->id - min_id],
+                           t->trigger_char);
+        }
+    }
+
+    // The old accepting states become the new start. A Thompson NFA has
+    // exactly one (nfa->end); otherwise a fresh start fans out to all of them.
+    if (nfa->end) {
+        reversed->start = copies[nfa->end->id - min_id];
+    } else {
+        reversed->start = create_state();
+        if (!reversed->start) {
+            free_state_copies(copies, max_id - min_id + 1);
+            free(states);
+            free(reversed);
+            return NULL;
+        }
+        for (int i = 0; i < count; i++) {
+            if (states[i]->is_accepting) {
+                add_transition(reversed->start, copies[states[i]->id - min_id], '\0');
+            }
+        }
+    }
+    reversed->end = copies[nfa->start->id - min_id];
+    reversed->end->is_accepting = 1;
+    reversed->is_epsilon_free = 0;
+
+    free(copies);
+    free(states);
+    return reversed;
+}
+
+Nfa* build_tagged_union_nfa(Nfa** nfas, int count) {
+    Nfa* combined = (Nfa*)malloc(sizeof(Nfa));
+    if (!combined) return NULL;
+
+    combined->start = create_state();
+    combined->end = NULL;
+    combined->is_epsilon_free = 0;
+
+    for (int i = 0; i < count; i++) {
+        // Tag every accepting state of this alternative with its index
+        int num_states = 0;
+        State** states = collect_states(nfas[i], &num_states);
+        if (states) {
+            for (int j = 0; j < num_states; j++) {
+                if (states[j]->is_accepting) states[j]->accept_id = i;
+            }
+            free(states);
+        }
+
+        add_transition(combined->start, nfas[i]->start, '\0');
+        free(nfas[i]);
+    }
+    return combined;
+}
+
+int measure_nfa(Nfa* nfa, NfaStats* stats) {
+    int count = 0;
+    State** states = collect_states(nfa, &count);
+    if (!states) return -1;
+
+    stats->num_states = count;
+    stats->num_positions = 0;
+    stats->min_id = states[0]->id;
+    stats->max_id = states[0]->id;
+    for (int i = 0; i < count; i++) {
+        if (states[i]->id < stats->min_id) stats->min_id = states[i]->id;
+        if (states[i]->id > stats->max_id) stats->max_id = states[i]->id;
+        for (int j = 0; j < states[i]->num_transitions; j++) {
+            if (states[i]->transitions[j]->trigger_char != '\0') {
+                stats->num_positions++;
+                break;
+            }
+        }
+    }
+    free(states);
+    return 0;
+}
+
 void free_nfa(Nfa* nfa) {
-    // TODO: This requires a graph traversal (like DFS or BFS) 
-    // to visit and free all states and transitions to avoid memory leaks. 
-    (void)nfa;
+    if (!nfa) return;
 
-}
\ No newline at end of file
+    int count = 0;
+    State** states = collect_states(nfa, &count);
+    if (states) {
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < states[i]->num_transitions; j++) {
+                free(states[i]->transitions[j]);
+            }
+            free(states[i]->transitions);
+            free(states[i]);
+        }
+        free(states);
+    }
+    free(nfa);
+}
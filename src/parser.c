@@ -1,4 +1,5 @@
 #include "parser.h"
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
@@ -13,20 +14,102 @@ static int precedence(char op) {
     return 0; // Other characters (operands)
 }
 
+// Maps the character after a backslash to the byte it stands for
+static unsigned char escaped_char(char c) {
+    switch (c) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+    }
+    return (unsigned char)c; // Any other escaped character is itself: \* -> *
+}
+
+int regex_operand_length(const char* regex) {
+    if (isalnum((unsigned char)regex[0])) {
+        return 1;
+    }
+    if (regex[0] == '\\') {
+        return regex[1] != '\0' ? 2 : 0;
+    }
+    if (regex[0] == '[') {
+        int i = 1;
+        if (regex[i] == '^') i++;
+        if (regex[i] == ']') i++; // A leading ']' is a literal member
+        while (regex[i] != '\0' && regex[i] != ']') {
+            if (regex[i] == '\\' && regex[i + 1] != '\0') i++;
+            i++;
+        }
+        return regex[i] == ']' ? i + 1 : 0; // Unterminated class: not an operand
+    }
+    return 0;
+}
+
+int regex_operand_chars(const char* operand, unsigned char set[256]) {
+    memset(set, 0, 256);
+    int length = regex_operand_length(operand);
+
+    if (length == 1) {
+        set[(unsigned char)operand[0]] = 1;
+    } else if (operand[0] == '\\' && length == 2) {
+        set[escaped_char(operand[1])] = 1;
+    } else if (length > 0) {
+        // Bracket class: members, ranges (a-z) and escapes, optionally negated
+        int i = 1;
+        int negated = 0;
+        if (operand[i] == '^') {
+            negated = 1;
+            i++;
+        }
+        int first_member = 1;
+        while (first_member || operand[i] != ']') {
+            first_member = 0;
+            unsigned char low = (unsigned char)operand[i];
+            if (operand[i] == '\\') low = escaped_char(operand[++i]);
+            i++;
+
+            unsigned char high = low;
+            if (operand[i] == '-' && operand[i + 1] != ']') {
+                i++;
+                high = (unsigned char)operand[i];
+                if (operand[i] == '\\') high = escaped_char(operand[++i]);
+                i++;
+            }
+            for (int c = low; c <= high; c++) {
+                set[c] = 1;
+            }
+        }
+        if (negated) {
+            for (int c = 0; c < 256; c++) set[c] = !set[c];
+        }
+    }
+
+    set[0] = 0; // NUL terminates strings and marks epsilon; it never matches
+    return length;
+}
+
 void preprocess_regex(const char* regex, char* outputBuffer, int bufferSize) {
     int j = 0;
     for (int i = 0; regex[i] != '\0'; i++) {
+        // Operands (a, \*, [a-z]) are copied whole so their inner
+        // characters are never mistaken for operators
+        int length = regex_operand_length(&regex[i]);
+        if (length == 0) length = 1;
+
         // Ensure we don't overflow the buffer
-        if (j >= bufferSize - 2) return;
+        if (j >= bufferSize - 1 - length) break;
 
-        // Copy the current character
-        outputBuffer[j++] = regex[i];
+        // Copy the current token
+        for (int k = 0; k < length; k++) {
+            outputBuffer[j++] = regex[i + k];
+        }
+        i += length - 1;
 
-        // Check the current and next characters to see if a '.' should be inserted
+        // Check the current and next tokens to see if a '.' should be inserted
         char current = regex[i];
-        char next = regex[i + 1];
+        const char* next = &regex[i + 1];
+        int current_is_operand = regex_operand_length(&regex[i - length + 1]) > 0;
 
-        if (next == '\0') continue;
+        if (*next == '\0') continue;
 
         // Conditions for inserting a '.'
         // 1. Current is an operand and next is an operand: ab -> a.b
@@ -35,26 +118,33 @@ void preprocess_regex(const char* regex, char* outputBuffer, int bufferSize) {
         // 4. Current is an operand and next is a '(': a(b) -> a.(b)
         // 5. Current is ')' and next is '(': (a)(b) -> (a).(b)
         // 6. Current is '*' and next is '(': a*(b) -> a*.(b)
-        if ((isalnum(current) || current == ')' || current == '*') &&
-            (isalnum(next) || next == '(')) {
+        if ((current_is_operand || current == ')' || current == '*') &&
+            (regex_operand_length(next) > 0 || *next == '(')) {
             outputBuffer[j++] = '.';
         }
     }
     outputBuffer[j] = '\0'; // Null-terminate the string
 }
 
-int regex_to_postfix(const char* infix, char* postfix, int bufferSize) {
-    char operator_stack[1024]; // A simple stack for operators
+/**
+ * @brief The Shunting-Yard loop behind regex_to_postfix().
+ * @param operator_stack Scratch space with room for strlen(infix) operators.
+ */
+static int shunting_yard(const char* infix, char* postfix, int bufferSize, char* operator_stack) {
     int stack_top = -1;
     int postfix_idx = 0;
 
     for (int i = 0; infix[i] != '\0'; i++) {
         char token = infix[i];
 
-        if (isalnum(token)) {
-            // If the token is an operand, add it to the output
-            if (postfix_idx >= bufferSize - 1) return -1;
-            postfix[postfix_idx++] = token;
+        int length = regex_operand_length(&infix[i]);
+        if (length > 0) {
+            // If the token is an operand, add it (all of it) to the output
+            if (postfix_idx >= bufferSize - length) return -1;
+            for (int k = 0; k < length; k++) {
+                postfix[postfix_idx++] = infix[i + k];
+            }
+            i += length - 1;
         } else if (token == '(') {
             // If it's a '(', push it onto the operator stack
             operator_stack[++stack_top] = token;
@@ -83,4 +173,16 @@ int regex_to_postfix(const char* infix, char* postfix, int bufferSize) {
 
     postfix[postfix_idx] = '\0'; // Null-terminate the postfix string
     return 0;
+}
+
+int regex_to_postfix(const char* infix, char* postfix, int bufferSize) {
+    // The stack never holds more operators than the infix has characters
+    char* operator_stack = (char*)malloc(strlen(infix) + 1);
+    if (!operator_stack) {
+        perror("Failed to allocate operator stack");
+        return -1;
+    }
+    int status = shunting_yard(infix, postfix, bufferSize, operator_stack);
+    free(operator_stack);
+    return status;
 }
\ No newline at end of file
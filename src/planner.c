@@ -0,0 +1,230 @@
+#include "planner.h"
+#include "simulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Tries to build the DFA(s) a plan needs within the budget.
+ * Writes the reason for the outcome into the plan either way.
+ * @return 1 if the DFA engine is ready, 0 if the plan must fall back.
+ */
+static int try_dfa(EnginePlan* plan, const DfaBudget* budget) {
+    // Estimate first, so hopeless patterns skip construction entirely.
+    // Each DFA state carries a full 256-entry transition table.
+    int num_dfas = plan->mode == PLAN_SPAN ? 2 : 1;
+    size_t estimated_bytes = (size_t)plan->estimated_dfa_states * sizeof(DfaState) * num_dfas;
+    if (plan->estimated_dfa_states > budget->max_states) {
+        snprintf(plan->reason, sizeof(plan->reason),
+                 "about %d DFA states expected, over the budget of %d",
+                 plan->estimated_dfa_states, budget->max_states);
+        return 0;
+    }
+    if (budget->max_bytes > 0 && estimated_bytes > budget->max_bytes) {
+        snprintf(plan->reason, sizeof(plan->reason),
+                 "about %lu KiB of DFA expected, over the budget of %lu KiB",
+                 (unsigned long)(estimated_bytes >> 10), (unsigned long)(budget->max_bytes >> 10));
+        return 0;
+    }
+
+    // The estimate can be far off (subset construction may blow up), so
+    // the build itself is budgeted too
+    // Spans need the forward DFA anchored (it runs from a known start) and
+    // the reverse one unanchored (it looks for starts anywhere)
+    DfaLimit over_budget = DFA_WITHIN_BUDGET;
+    plan->dfa = nfa_to_dfa_within_budget(plan->nfa, plan->mode == PLAN_SEARCH, budget, &over_budget);
+    size_t num_bytes = plan->dfa ? plan->dfa->num_bytes : 0;
+    if (plan->dfa && plan->mode == PLAN_SPAN) {
+        // The reverse DFA gets whatever memory the forward one left over
+        DfaBudget rest = *budget;
+        if (rest.max_bytes > 0) {
+            rest.max_bytes = rest.max_bytes > num_bytes ? rest.max_bytes - num_bytes : 1;
+        }
+        plan->reverse_dfa = nfa_to_dfa_within_budget(plan->reversed, 1, &rest, &over_budget);
+        num_bytes += plan->reverse_dfa ? plan->reverse_dfa->num_bytes : 0;
+    }
+
+    if (plan->dfa == NULL || (plan->mode == PLAN_SPAN && plan->reverse_dfa == NULL)) {
+        free_dfa(plan->dfa);
+        free_dfa(plan->reverse_dfa);
+        plan->dfa = NULL;
+        plan->reverse_dfa = NULL;
+        if (over_budget == DFA_STATE_LIMIT) {
+            snprintf(plan->reason, sizeof(plan->reason),
+                     "subset construction passed the budget of %d states", budget->max_states);
+        } else if (over_budget == DFA_BYTE_LIMIT) {
+            snprintf(plan->reason, sizeof(plan->reason),
+                     "subset construction passed the budget of %lu KiB",
+                     (unsigned long)(budget->max_bytes >> 10));
+        } else {
+            snprintf(plan->reason, sizeof(plan->reason), "DFA construction failed");
+        }
+        return 0;
+    }
+
+    int num_states = plan->dfa->num_states + (plan->reverse_dfa ? plan->reverse_dfa->num_states : 0);
+    snprintf(plan->reason, sizeof(plan->reason), "%d DFA states (%lu KiB) fit the budget",
+             num_states, (unsigned long)(num_bytes >> 10));
+    return 1;
+}
+
+EnginePlan* plan_engine(Nfa* nfa, const char* regex, const char* postfix, PlanMode mode,
+                        const DfaBudget* budget) {
+    DfaBudget defaults = { PLANNER_MAX_DFA_STATES, PLANNER_MAX_DFA_BYTES };
+    if (budget == NULL) {
+        budget = &defaults;
+    }
+
+    EnginePlan* plan = (EnginePlan*)calloc(1, sizeof(EnginePlan));
+    if (!plan) {
+        perror("Failed to allocate EnginePlan");
+        return NULL;
+    }
+    plan->mode = mode;
+    plan->nfa = nfa;
+    if (measure_nfa(nfa, &plan->stats) != 0) {
+        perror("Failed to measure NFA");
+        free(plan);
+        return NULL;
+    }
+    // A DFA usually has about one state per position (plus a start state);
+    // the exponential worst case is what the budget guards against
+    plan->estimated_dfa_states = plan->stats.num_positions + 1;
+
+    // Keyword lists too long for the bit-parallel engine: a trie is linear
+    // to build and scan, and needs no reversal for spans
+    int literal_size = regex ? literal_alternation_size(regex) : -1;
+    if (literal_size > SHIFT_AND_MAX_POSITIONS) {
+        plan->aho_corasick = build_aho_corasick(regex);
+        if (plan->aho_corasick) {
+            plan->engine = ENGINE_AHO_CORASICK;
+            snprintf(plan->reason, sizeof(plan->reason), "%d keywords (%d literal characters) in one trie",
+                     plan->aho_corasick->num_words, literal_size);
+            return plan;
+        }
+    }
+
+    // Spans are found with a backward pass, which needs the reversal
+    if (mode == PLAN_SPAN) {
+        plan->reversed = reverse_nfa(nfa);
+        if (plan->reversed == NULL) {
+            fprintf(stderr, "Error: Cannot reverse the NFA.\n");
+            free_engine_plan(plan);
+            return NULL;
+        }
+    }
+
+    // Small patterns: the bit-parallel engine needs no construction at all
+    if (mode == PLAN_FULL_MATCH && postfix && shift_and_fits(postfix)) {
+        plan->shift_and = build_shift_and(postfix);
+        if (plan->shift_and) {
+            plan->engine = ENGINE_SHIFT_AND;
+            snprintf(plan->reason, sizeof(plan->reason), "%d positions fit one machine word",
+                     plan->shift_and->num_positions);
+            return plan;
+        }
+    }
+
+    if (try_dfa(plan, budget)) {
+        plan->engine = ENGINE_DFA;
+        return plan;
+    }
+
+    // Over budget: a slower match is better than failing to compile. The
+    // run reuses the measurements taken above; the reversal is measured here.
+    plan->engine = ENGINE_NFA;
+    size_t length = strlen(plan->reason);
+    snprintf(plan->reason + length, sizeof(plan->reason) - length, "; simulating the NFA");
+    plan->run = create_nfa_run(nfa, &plan->stats);
+    if (plan->run && mode == PLAN_SPAN) {
+        plan->reverse_run = create_nfa_run(plan->reversed, NULL);
+    }
+    if (plan->run == NULL || (mode == PLAN_SPAN && plan->reverse_run == NULL)) {
+        free_engine_plan(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+int plan_match(const EnginePlan* plan, const char* str) {
+    if (plan->engine == ENGINE_SHIFT_AND) {
+        return simulate_shift_and(plan->shift_and, str);
+    }
+    if (plan->engine == ENGINE_AHO_CORASICK) {
+        return simulate_aho_corasick(plan->aho_corasick, str);
+    }
+    if (plan->mode == PLAN_SEARCH) {
+        return 0; // Search DFAs are unanchored, so they cannot answer a full match
+    }
+    if (plan->engine == ENGINE_DFA) {
+        return simulate_dfa(plan->dfa, str);
+    }
+    return simulate_nfa_run(plan->run, str);
+}
+
+int plan_needs_run(const EnginePlan* plan) {
+    // Only search DFAs restart at every position; span plans keep an
+    // anchored forward DFA, so they scan with the NFA instead
+    if (plan->mode == PLAN_FULL_MATCH || plan->engine == ENGINE_AHO_CORASICK) {
+        return 0;
+    }
+    return plan->engine == ENGINE_NFA || plan->mode == PLAN_SPAN;
+}
+
+NfaRun* create_plan_run(const EnginePlan* plan) {
+    if (!plan_needs_run(plan)) {
+        return NULL;
+    }
+    return create_nfa_run(plan->nfa, &plan->stats);
+}
+
+int plan_has_match(const EnginePlan* plan, NfaRun* run, const char* text, size_t length) {
+    if (plan->mode == PLAN_FULL_MATCH) {
+        return 0; // Full-match plans may hold a Shift-And machine, which cannot search
+    }
+    if (plan->engine == ENGINE_AHO_CORASICK) {
+        return aho_corasick_has_match(plan->aho_corasick, text, length);
+    }
+    if (!plan_needs_run(plan)) {
+        return dfa_has_match(plan->dfa, text, length);
+    }
+    if (run == NULL) {
+        return 0; // The caller's run from create_plan_run() is required here
+    }
+    return nfa_has_match(run, text, length);
+}
+
+int plan_search(const EnginePlan* plan, const char* str, int* match_start, int* match_end) {
+    if (plan->mode != PLAN_SPAN) {
+        return 0; // Only span plans carry the reversed automaton
+    }
+    if (plan->engine == ENGINE_AHO_CORASICK) {
+        return search_aho_corasick(plan->aho_corasick, str, match_start, match_end);
+    }
+    if (plan->engine == ENGINE_DFA) {
+        return search_dfa(plan->dfa, plan->reverse_dfa, str, match_start, match_end);
+    }
+    return search_nfa(plan->run, plan->reverse_run, str, match_start, match_end);
+}
+
+const char* engine_name(EngineKind engine) {
+    switch (engine) {
+        case ENGINE_SHIFT_AND:    return "Shift-And";
+        case ENGINE_AHO_CORASICK: return "Aho-Corasick";
+        case ENGINE_DFA:          return "DFA";
+        case ENGINE_NFA:          return "NFA";
+        default:                  return "UNKNOWN";
+    }
+}
+
+void free_engine_plan(EnginePlan* plan) {
+    if (!plan) return;
+    free_nfa(plan->reversed);
+    free_dfa(plan->dfa);
+    free_dfa(plan->reverse_dfa);
+    free_shift_and(plan->shift_and);
+    free_aho_corasick(plan->aho_corasick);
+    free_nfa_run(plan->run);
+    free_nfa_run(plan->reverse_run);
+    free(plan);
+}
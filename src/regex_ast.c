@@ -0,0 +1,567 @@
+#include "regex_ast.h"
+#include "parser.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+// --- Node Helpers ---
+
+/**
+ * @brief Creates a new node with no text and no children.
+ */
+static RegexNode* create_node(RegexNodeType type) {
+    RegexNode* node = (RegexNode*)calloc(1, sizeof(RegexNode));
+    if (!node) {
+        perror("Failed to allocate RegexNode");
+        return NULL;
+    }
+    node->type = type;
+    return node;
+}
+
+/**
+ * @brief Creates a literal or class node holding a copy of 'length' characters.
+ */
+static RegexNode* create_text_node(RegexNodeType type, const char* text, int length) {
+    RegexNode* node = create_node(type);
+    if (!node) return NULL;
+
+    node->text = (char*)malloc(length);
+    if (!node->text) {
+        perror("Failed to allocate literal text");
+        free(node);
+        return NULL;
+    }
+    memcpy(node->text, text, length);
+    node->text_length = length;
+    return node;
+}
+
+/**
+ * @brief Creates a literal node holding a copy of 'length' characters.
+ */
+static RegexNode* create_literal(const char* text, int length) {
+    return create_text_node(REGEX_LITERAL, text, length);
+}
+
+/**
+ * @brief Appends a child to a concatenation, union or star node.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int add_child(RegexNode* parent, RegexNode* child) {
+    RegexNode** grown = (RegexNode**)realloc(parent->children,
+                                             (parent->num_children + 1) * sizeof(RegexNode*));
+    if (!grown) {
+        perror("Failed to grow RegexNode children");
+        return -1;
+    }
+    parent->children = grown;
+    parent->children[parent->num_children++] = child;
+    return 0;
+}
+
+/**
+ * @brief Frees a node's own storage but not its children, so the
+ * children can be moved into another node.
+ */
+static void free_node_shell(RegexNode* node) {
+    free(node->text);
+    free(node->children);
+    free(node);
+}
+
+/**
+ * @brief Checks whether two trees are structurally identical.
+ */
+static int ast_equal(RegexNode* a, RegexNode* b) {
+    if (a->type != b->type) return 0;
+
+    if (a->type == REGEX_LITERAL || a->type == REGEX_CLASS) {
+        return a->text_length == b->text_length &&
+               memcmp(a->text, b->text, a->text_length) == 0;
+    }
+
+    if (a->num_children != b->num_children) return 0;
+    for (int i = 0; i < a->num_children; i++) {
+        if (!ast_equal(a->children[i], b->children[i])) return 0;
+    }
+    return 1;
+}
+
+// --- Rewrite Passes ---
+// Each simplify_* function expects the node's children to be optimized
+// already, rewrites only the node itself, and returns its replacement.
+
+static RegexNode* simplify_union(RegexNode* node);
+
+/**
+ * @brief Flattens nested concatenations and merges adjacent literals.
+ * e.g. CONCAT(a, CONCAT(b, c*)) -> CONCAT("ab", c*)
+ */
+static RegexNode* simplify_concat(RegexNode* node) {
+    RegexNode** old_children = node->children;
+    int old_count = node->num_children;
+    node->children = NULL;
+    node->num_children = 0;
+
+    for (int i = 0; i < old_count; i++) {
+        RegexNode* child = old_children[i];
+
+        // Splice in the children of a nested concatenation
+        RegexNode** parts = &child;
+        int num_parts = 1;
+        int spliced = child->type == REGEX_CONCAT;
+        if (spliced) {
+            parts = child->children;
+            num_parts = child->num_children;
+        }
+
+        for (int j = 0; j < num_parts; j++) {
+            RegexNode* part = parts[j];
+            RegexNode* previous = node->num_children > 0
+                                  ? node->children[node->num_children - 1] : NULL;
+
+            // Literal-string merging: "ab" followed by "c" becomes "abc"
+            if (previous && previous->type == REGEX_LITERAL && part->type == REGEX_LITERAL) {
+                char* merged = (char*)realloc(previous->text,
+                                              previous->text_length + part->text_length);
+                if (merged) {
+                    memcpy(merged + previous->text_length, part->text, part->text_length);
+                    previous->text = merged;
+                    previous->text_length += part->text_length;
+                    free_ast(part);
+                    continue;
+                }
+            }
+            add_child(node, part);
+        }
+
+        if (spliced) {
+            free_node_shell(child);
+        }
+    }
+    free(old_children);
+
+    // A concatenation of one thing is just that thing
+    if (node->num_children == 1) {
+        RegexNode* only = node->children[0];
+        free_node_shell(node);
+        return only;
+    }
+    return node;
+}
+
+/**
+ * @brief Simplifies a sub-expression that sits directly under a star.
+ * Under a star, inner stars add nothing: (x*)* = x*, (x*|y)* = (x|y)*,
+ * and a concatenation of stars repeats into the union of their bodies:
+ * (x*y*)* = (x|y)*.
+ */
+static RegexNode* unwrap_starred(RegexNode* node) {
+    if (node->type == REGEX_STAR) {
+        RegexNode* body = node->children[0];
+        free_node_shell(node);
+        return body;
+    }
+
+    if (node->type == REGEX_UNION) {
+        for (int i = 0; i < node->num_children; i++) {
+            node->children[i] = unwrap_starred(node->children[i]);
+        }
+        return simplify_union(node);
+    }
+
+    if (node->type == REGEX_CONCAT) {
+        for (int i = 0; i < node->num_children; i++) {
+            if (node->children[i]->type != REGEX_STAR) return node;
+        }
+        node->type = REGEX_UNION;
+        for (int i = 0; i < node->num_children; i++) {
+            node->children[i] = unwrap_starred(node->children[i]);
+        }
+        return simplify_union(node);
+    }
+
+    return node;
+}
+
+/**
+ * @brief Star flattening: (x*)* -> x*, plus the rewrites of unwrap_starred().
+ */
+static RegexNode* simplify_star(RegexNode* node) {
+    RegexNode* body = node->children[0];
+
+    if (body->type == REGEX_STAR) {
+        free_node_shell(node);
+        return body;
+    }
+
+    node->children[0] = unwrap_starred(body);
+    return node;
+}
+
+/**
+ * @brief Returns the literal run at the start (or end) of an alternative,
+ * or NULL if it does not begin (end) with a literal.
+ */
+static RegexNode* edge_literal(RegexNode* node, int from_end) {
+    if (node->type == REGEX_LITERAL) return node;
+    if (node->type == REGEX_CONCAT) {
+        RegexNode* edge = node->children[from_end ? node->num_children - 1 : 0];
+        if (edge->type == REGEX_LITERAL) return edge;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Returns the k-th character counted from the start (or end).
+ */
+static char edge_char(RegexNode* literal, int k, int from_end) {
+    return from_end ? literal->text[literal->text_length - 1 - k] : literal->text[k];
+}
+
+/**
+ * @brief How many edge characters can be factored out of an alternative.
+ * The regex syntax has no empty-string operand, so a bare literal must
+ * keep at least one character behind.
+ */
+static int factorable_length(RegexNode* node, int from_end) {
+    RegexNode* literal = edge_literal(node, from_end);
+    if (!literal) return 0;
+    return node->type == REGEX_LITERAL ? literal->text_length - 1 : literal->text_length;
+}
+
+/**
+ * @brief Removes 'count' characters from the start (or end) of an alternative.
+ * @return The remaining expression (may be a different node).
+ */
+static RegexNode* strip_edge(RegexNode* node, int count, int from_end) {
+    RegexNode* literal = edge_literal(node, from_end);
+
+    if (node->type == REGEX_CONCAT && literal->text_length == count) {
+        // The whole leading (trailing) literal goes away
+        if (!from_end) {
+            memmove(node->children, node->children + 1,
+                    (node->num_children - 1) * sizeof(RegexNode*));
+        }
+        node->num_children--;
+        free_ast(literal);
+
+        if (node->num_children == 1) {
+            RegexNode* only = node->children[0];
+            free_node_shell(node);
+            return only;
+        }
+        return node;
+    }
+
+    if (!from_end) {
+        memmove(literal->text, literal->text + count, literal->text_length - count);
+    }
+    literal->text_length -= count;
+    return node;
+}
+
+/**
+ * @brief Factors shared literal prefixes (or suffixes) out of the
+ * alternatives of a union: abc|abd|x -> ab(c|d)|x, and xz|yz -> (x|y)z.
+ */
+static void factor_union(RegexNode* node, int from_end) {
+    int n = node->num_children;
+    RegexNode** alternatives = node->children;
+    RegexNode** result = (RegexNode**)malloc(n * sizeof(RegexNode*));
+    int* group = (int*)malloc(n * sizeof(int));
+    int* used = (int*)calloc(n, sizeof(int));
+    if (!result || !group || !used) {
+        free(result);
+        free(group);
+        free(used);
+        return; // Factoring is only an optimization; leave the union as is
+    }
+    int count = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (used[i]) continue;
+        used[i] = 1;
+
+        int limit = factorable_length(alternatives[i], from_end);
+        if (limit == 0) {
+            result[count++] = alternatives[i];
+            continue;
+        }
+
+        // Gather every later alternative sharing the same edge character
+        RegexNode* first = edge_literal(alternatives[i], from_end);
+        int group_size = 0;
+        group[group_size++] = i;
+        for (int j = i + 1; j < n; j++) {
+            int length = used[j] ? 0 : factorable_length(alternatives[j], from_end);
+            if (length > 0 &&
+                edge_char(edge_literal(alternatives[j], from_end), 0, from_end) ==
+                edge_char(first, 0, from_end)) {
+                group[group_size++] = j;
+                if (length < limit) limit = length;
+            }
+        }
+
+        if (group_size == 1) {
+            result[count++] = alternatives[i];
+            continue;
+        }
+
+        // Longest run of edge characters shared by the whole group
+        int shared = 1;
+        while (shared < limit) {
+            int same = 1;
+            for (int g = 1; g < group_size && same; g++) {
+                RegexNode* literal = edge_literal(alternatives[group[g]], from_end);
+                same = edge_char(literal, shared, from_end) == edge_char(first, shared, from_end);
+            }
+            if (!same) break;
+            shared++;
+        }
+
+        RegexNode* common = create_literal(
+            from_end ? first->text + first->text_length - shared : first->text, shared);
+        RegexNode* rest = create_node(REGEX_UNION);
+        RegexNode* joined = create_node(REGEX_CONCAT);
+        if (!common || !rest || !joined) {
+            free_ast(common);
+            free(rest);
+            free(joined);
+            result[count++] = alternatives[i];
+            continue;
+        }
+
+        for (int g = 0; g < group_size; g++) {
+            used[group[g]] = 1;
+            add_child(rest, strip_edge(alternatives[group[g]], shared, from_end));
+        }
+        rest = simplify_union(rest);
+
+        add_child(joined, from_end ? rest : common);
+        add_child(joined, from_end ? common : rest);
+        result[count++] = simplify_concat(joined);
+    }
+
+    free(alternatives);
+    free(group);
+    free(used);
+    node->children = result;
+    node->num_children = count;
+}
+
+/**
+ * @brief Flattens nested unions, removes duplicate alternatives and
+ * factors common prefixes and suffixes.
+ */
+static RegexNode* simplify_union(RegexNode* node) {
+    RegexNode** old_children = node->children;
+    int old_count = node->num_children;
+    node->children = NULL;
+    node->num_children = 0;
+
+    for (int i = 0; i < old_count; i++) {
+        RegexNode* child = old_children[i];
+
+        // Splice in the alternatives of a nested union
+        RegexNode** parts = &child;
+        int num_parts = 1;
+        int spliced = child->type == REGEX_UNION;
+        if (spliced) {
+            parts = child->children;
+            num_parts = child->num_children;
+        }
+
+        for (int j = 0; j < num_parts; j++) {
+            // Duplicate-alternative removal: a|b|a -> a|b
+            int duplicate = 0;
+            for (int k = 0; k < node->num_children; k++) {
+                if (ast_equal(node->children[k], parts[j])) {
+                    duplicate = 1;
+                    break;
+                }
+            }
+            if (duplicate) {
+                free_ast(parts[j]);
+            } else {
+                add_child(node, parts[j]);
+            }
+        }
+
+        if (spliced) {
+            free_node_shell(child);
+        }
+    }
+    free(old_children);
+
+    factor_union(node, 0);
+    factor_union(node, 1);
+
+    // A union of one thing is just that thing
+    if (node->num_children == 1) {
+        RegexNode* only = node->children[0];
+        free_node_shell(node);
+        return only;
+    }
+    return node;
+}
+
+/**
+ * @brief Appends one character to the postfix output.
+ * @return 0 on success, -1 if the buffer is full.
+ */
+static int emit_char(char c, char* postfix, int* index, int bufferSize) {
+    if (*index >= bufferSize - 1) return -1;
+    postfix[(*index)++] = c;
+    return 0;
+}
+
+/**
+ * @brief Writes a node in postfix form; n-ary nodes become chains of
+ * binary operators, and a literal run "abc" becomes "ab.c.".
+ * Literal characters that are not alphanumeric are written as escapes.
+ */
+static int emit_postfix(RegexNode* node, char* postfix, int* index, int bufferSize) {
+    switch (node->type) {
+        case REGEX_LITERAL:
+            for (int i = 0; i < node->text_length; i++) {
+                if (!isalnum((unsigned char)node->text[i]) &&
+                    emit_char('\\', postfix, index, bufferSize) != 0) return -1;
+                if (emit_char(node->text[i], postfix, index, bufferSize) != 0) return -1;
+                if (i > 0 && emit_char('.', postfix, index, bufferSize) != 0) return -1;
+            }
+            return 0;
+        case REGEX_CLASS:
+            for (int i = 0; i < node->text_length; i++) {
+                if (emit_char(node->text[i], postfix, index, bufferSize) != 0) return -1;
+            }
+            return 0;
+        case REGEX_CONCAT:
+        case REGEX_UNION: {
+            char op = node->type == REGEX_CONCAT ? '.' : '|';
+            for (int i = 0; i < node->num_children; i++) {
+                if (emit_postfix(node->children[i], postfix, index, bufferSize) != 0) return -1;
+                if (i > 0 && emit_char(op, postfix, index, bufferSize) != 0) return -1;
+            }
+            return 0;
+        }
+        case REGEX_STAR:
+            if (emit_postfix(node->children[0], postfix, index, bufferSize) != 0) return -1;
+            return emit_char('*', postfix, index, bufferSize);
+    }
+    return -1;
+}
+
+
+// --- Public Functions ---
+
+RegexNode* build_ast_from_postfix(const char* postfix) {
+    int length = (int)strlen(postfix);
+    RegexNode** stack = (RegexNode**)malloc((length + 1) * sizeof(RegexNode*));
+    if (!stack) return NULL;
+    int stack_top = -1;
+    int failed = 0;
+
+    for (int i = 0; postfix[i] != '\0' && !failed; i++) {
+        char token = postfix[i];
+        unsigned char set[256];
+        int length = regex_operand_chars(&postfix[i], set);
+
+        if (length > 0) {
+            // Operands matching exactly one byte become literals (so they
+            // can merge and be factored); real classes stay as written
+            int members = 0;
+            char only = 0;
+            for (int c = 1; c < 256; c++) {
+                if (set[c]) {
+                    members++;
+                    only = (char)c;
+                }
+            }
+            RegexNode* operand = members == 1
+                                 ? create_literal(&only, 1)
+                                 : create_text_node(REGEX_CLASS, &postfix[i], length);
+            if (!operand) {
+                failed = 1;
+                break;
+            }
+            stack[++stack_top] = operand;
+            i += length - 1;
+        } else if (token == '.' || token == '|') {
+            if (stack_top < 1) {
+                failed = 1;
+                break;
+            }
+            RegexNode* right = stack[stack_top--];
+            RegexNode* left = stack[stack_top--];
+            RegexNode* node = create_node(token == '.' ? REGEX_CONCAT : REGEX_UNION);
+            if (!node || add_child(node, left) != 0 || add_child(node, right) != 0) {
+                free_ast(node);
+                free_ast(left);
+                free_ast(right);
+                failed = 1;
+                break;
+            }
+            stack[++stack_top] = node;
+        } else if (token == '*') {
+            if (stack_top < 0) {
+                failed = 1;
+                break;
+            }
+            RegexNode* body = stack[stack_top--];
+            RegexNode* node = create_node(REGEX_STAR);
+            if (!node || add_child(node, body) != 0) {
+                free_ast(node);
+                free_ast(body);
+                failed = 1;
+                break;
+            }
+            stack[++stack_top] = node;
+        }
+    }
+
+    if (failed || stack_top != 0) {
+        while (stack_top > -1) free_ast(stack[stack_top--]);
+        free(stack);
+        return NULL;
+    }
+
+    RegexNode* root = stack[0];
+    free(stack);
+    return root;
+}
+
+RegexNode* optimize_ast(RegexNode* node) {
+    if (node->type == REGEX_LITERAL || node->type == REGEX_CLASS) {
+        return node;
+    }
+
+    // Bottom-up: children first, then this node
+    for (int i = 0; i < node->num_children; i++) {
+        node->children[i] = optimize_ast(node->children[i]);
+    }
+
+    switch (node->type) {
+        case REGEX_CONCAT: return simplify_concat(node);
+        case REGEX_UNION:  return simplify_union(node);
+        case REGEX_STAR:   return simplify_star(node);
+        default:           return node;
+    }
+}
+
+int ast_to_postfix(RegexNode* node, char* postfix, int bufferSize) {
+    int index = 0;
+    if (emit_postfix(node, postfix, &index, bufferSize) != 0) return -1;
+    postfix[index] = '\0';
+    return 0;
+}
+
+void free_ast(RegexNode* node) {
+    if (!node) return;
+    for (int i = 0; i < node->num_children; i++) {
+        free_ast(node->children[i]);
+    }
+    free_node_shell(node);
+}
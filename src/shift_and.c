@@ -0,0 +1,166 @@
+#include "shift_and.h"
+#include "parser.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+/**
+ * @struct Fragment
+ * @brief The Glushkov summary of a sub-expression, built on a stack
+ * exactly like the NFA fragments in Thompson's construction.
+ */
+typedef struct Fragment {
+    uint64_t first;   // Positions that can start the sub-expression
+    uint64_t last;    // Positions that can end the sub-expression
+    int nullable;     // 1 if the sub-expression matches the empty string
+} Fragment;
+
+/**
+ * @brief Records that every position in 'from' may be followed by every
+ * position in 'to'.
+ */
+static void add_follow(uint64_t* follow, uint64_t from, uint64_t to) {
+    for (int p = 0; p < SHIFT_AND_MAX_POSITIONS; p++) {
+        if (from & ((uint64_t)1 << p)) {
+            follow[p] |= to;
+        }
+    }
+}
+
+/**
+ * @brief Computes the set of positions that may follow any position in 'state'.
+ * One table lookup per occupied byte of the mask.
+ */
+static uint64_t next_positions(ShiftAndNfa* sa, uint64_t state) {
+    uint64_t next = 0;
+    for (int k = 0; state != 0; k++, state >>= 8) {
+        next |= sa->follow_tables[k][state & 0xFF];
+    }
+    return next;
+}
+
+// --- Public Functions ---
+
+int shift_and_fits(const char* postfix) {
+    int positions = 0;
+    for (int i = 0; postfix[i] != '\0'; i++) {
+        int length = regex_operand_length(&postfix[i]);
+        if (length > 0) {
+            positions++;
+            i += length - 1;
+        }
+    }
+    return positions <= SHIFT_AND_MAX_POSITIONS;
+}
+
+ShiftAndNfa* build_shift_and(const char* postfix) {
+    if (!shift_and_fits(postfix)) {
+        return NULL;
+    }
+
+    ShiftAndNfa* sa = (ShiftAndNfa*)calloc(1, sizeof(ShiftAndNfa));
+    if (!sa) {
+        perror("Failed to allocate ShiftAndNfa");
+        return NULL;
+    }
+
+    // follow[p]: the positions that may come right after position p
+    uint64_t follow[SHIFT_AND_MAX_POSITIONS] = {0};
+
+    // A fragment only exists per operand, so 64 entries are always enough
+    Fragment stack[SHIFT_AND_MAX_POSITIONS];
+    int stack_top = -1;
+
+    for (int i = 0; postfix[i] != '\0'; i++) {
+        char token = postfix[i];
+        unsigned char set[256];
+        int length = regex_operand_chars(&postfix[i], set);
+
+        if (length > 0) {
+            // Operand: a new position that is both first and last. Every
+            // byte the operand matches (one, or a whole class) gets its bit.
+            uint64_t bit = (uint64_t)1 << sa->num_positions++;
+            for (int c = 1; c < 256; c++) {
+                if (set[c]) sa->char_masks[c] |= bit;
+            }
+            stack[++stack_top] = (Fragment){ bit, bit, 0 };
+            i += length - 1;
+        } else if (token == '.' || token == '|') {
+            if (stack_top < 1) {
+                free(sa);
+                return NULL;
+            }
+            Fragment f2 = stack[stack_top--];
+            Fragment f1 = stack[stack_top--];
+            Fragment result;
+
+            if (token == '.') {
+                // Concatenation: the end of f1 flows into the start of f2
+                add_follow(follow, f1.last, f2.first);
+                result.first = f1.nullable ? (f1.first | f2.first) : f1.first;
+                result.last = f2.nullable ? (f1.last | f2.last) : f2.last;
+                result.nullable = f1.nullable && f2.nullable;
+            } else {
+                // Union: either side may start or end the match
+                result.first = f1.first | f2.first;
+                result.last = f1.last | f2.last;
+                result.nullable = f1.nullable || f2.nullable;
+            }
+            stack[++stack_top] = result;
+        } else if (token == '*') {
+            if (stack_top < 0) {
+                free(sa);
+                return NULL;
+            }
+            // Star: the end of the fragment loops back to its start
+            add_follow(follow, stack[stack_top].last, stack[stack_top].first);
+            stack[stack_top].nullable = 1;
+        }
+    }
+
+    if (stack_top != 0) {
+        fprintf(stderr, "Error: Shift-And stack should have exactly one item at the end.\n");
+        free(sa);
+        return NULL;
+    }
+
+    sa->first = stack[0].first;
+    sa->last = stack[0].last;
+    sa->nullable = stack[0].nullable;
+
+    // Precompute the follow set of every possible byte of the state mask
+    for (int k = 0; k < SHIFT_AND_CHUNKS; k++) {
+        for (int b = 0; b < 256; b++) {
+            uint64_t next = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                if (b & (1 << bit)) {
+                    next |= follow[k * 8 + bit];
+                }
+            }
+            sa->follow_tables[k][b] = next;
+        }
+    }
+
+    return sa;
+}
+
+int simulate_shift_and(ShiftAndNfa* sa, const char* str) {
+    if (str[0] == '\0') {
+        return sa->nullable;
+    }
+
+    // The first character may only land on a 'first' position
+    uint64_t state = sa->first & sa->char_masks[(unsigned char)str[0]];
+
+    for (int i = 1; str[i] != '\0' && state != 0; i++) {
+        // Move every active position to its followers, then keep only
+        // those labelled with the current character
+        state = next_positions(sa, state) & sa->char_masks[(unsigned char)str[i]];
+    }
+
+    // If the state emptied out early we never reach an accepting position
+    return (state & sa->last) != 0;
+}
+
+void free_shift_and(ShiftAndNfa* sa) {
+    free(sa);
+}
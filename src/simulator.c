@@ -1,114 +1,256 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 #include "simulator.h"
 
-// Maximum number of states you can track at once
-#define MAX_STATES 1024 
-
 
 /* HELPER FUNCTIONS */
 
 
 /**
- * @brief Adds a state to a state-set, hence avoiding duplicates
- * 
+ * @brief The working state of NFA simulations, reused from call to call.
+ *
+ * Both state sets are sized for every state of the NFA, so no pattern can
+ * overflow them, and each state ID has a stamp that marks it as already
+ * in the next set, which makes the duplicate check constant-time. The
+ * generation keeps counting across calls, so stamps never need clearing.
+ */
+struct NfaRun {
+    Nfa* nfa;
+    State** current;        // States we are in right now
+    int current_count;
+    State** next;           // States we will be in after the next character
+    int next_count;
+    int* stamps;            // stamps[id - min_id] == generation: state is in 'next'
+    int num_stamps;
+    int generation;
+    int min_id;
+    int follow_epsilon;     // 0 for epsilon-free (Glushkov) NFAs
+};
+
+/**
+ * @brief Empties the next set before it is filled for another character
+ */
+static void begin_step(NfaRun* run) {
+    if (run->generation == INT_MAX) {
+        // Practically never: restart the stamps rather than wrap around
+        memset(run->stamps, 0, run->num_stamps * sizeof(int));
+        run->generation = 0;
+    }
+    run->generation++;
+    run->next_count = 0;
+}
+
+/**
+ * @brief Adds a state to the next set, hence avoiding duplicates
+ *
  * Also recursively adds all states reachable (epsilon transitions)
- * 
+ *
+ * @param run The simulation whose next set receives the state
  * @param state The state to add
- * @param set The array of state pointers
- * @param count Pointer to teh current number of states in the set
- * 
+ *
  * @returns void
  */
-static void add_state_to_set(State* state, State** set, int* count) {
+static void add_state_to_set(NfaRun* run, State* state) {
     if (state == NULL) {
         return;
     }
 
     // check if state is already in the set
-    for (int i = 0; i < *count; i++) {
-        if (set[i] == state) {
-            return; // return if theres a duplicate already present
-        }
+    int* stamp = &run->stamps[state->id - run->min_id];
+    if (*stamp == run->generation) {
+        return; // return if theres a duplicate already present
     }
+    *stamp = run->generation;
 
     // Add the state if not present in state set
-    set[(*count)++] = state;
+    run->next[run->next_count++] = state;
+
+    if (!run->follow_epsilon) {
+        return;
+    }
 
     // if e-transitions are present, add the targets recursively
     for (int i = 0; i < state->num_transitions; i++) {
         if (state->transitions[i]->trigger_char == '\0') {
-            add_state_to_set(state->transitions[i]->target_state, set, count);
-        } 
+            add_state_to_set(run, state->transitions[i]->target_state);
+        }
     }
 }
 
-// --- Public Facing Simulator Function --- 
+/**
+ * @brief Swap: the next set becomes the current set
+ */
+static void finish_step(NfaRun* run) {
+    State** swap = run->current;
+    run->current = run->next;
+    run->current_count = run->next_count;
+    run->next = swap;
+}
+
+/**
+ * @brief Enters the start state (and its closure)
+ */
+static void start_run(NfaRun* run) {
+    begin_step(run);
+    add_state_to_set(run, run->nfa->start);
+    finish_step(run);
+}
 
 /**
- * @brief Simulates an NFA against a given string
- * 
- * @param nfa The NFA (Start State) to emulate
- * 
- * @returns 1 (true) if the string is accepted
- * 
- * @returns 0 (false) if the string is rejected
+ * @brief Consumes one character
+ *
+ * @param restart If set, the start state is re-entered after the
+ *                character, so a match can begin at any position
+ *                (the NFA counterpart of nfa_to_search_dfa())
  */
-int simulate_nfa(Nfa* nfa, const char* str) {
-    // Set of states we are in right now
-    State* current_states[MAX_STATES];
-    // Set of states we will be in after consuming the next char
-    State* next_states[MAX_STATES];
+static void step_run(NfaRun* run, char c, int restart) {
+    begin_step(run);
+    if (restart) {
+        add_state_to_set(run, run->nfa->start);
+    }
 
-    int current_count = 0;
-    int next_count = 0;
+    // For each state we are currently in...
+    for (int j = 0; j < run->current_count; j++) {
+        State* state = run->current[j];
 
-    // current set starts with NFA's start state + epsilon closure.
-    add_state_to_set(nfa->start, current_states, &current_count);
+        // ...check all its transitions...
+        for (int k = 0; k < state->num_transitions; k++) {
+            Transition* t = state->transitions[k];
 
-    // loop through each character in the string
-    for (int i = 0; str[i] != '\0'; i++) {
-        char c = str[i];
-        next_count = 0; // Reset the next_states set
-
-        // For each state we are currently in...
-        for (int j = 0; j < current_count; j++) {
-            State* state = current_states[j];
-
-            // ...check all its transitions...
-            for (int k = 0; k < state->num_transitions; k++) {
-                Transition* t = state->transitions[k];
-
-                // ...to see if one matches the current character.
-                if (t->trigger_char == c) {
-                    // If it matches, add the target state (and its closure)
-                    // to the *next* set of states.
-                    add_state_to_set(t->target_state, next_states, &next_count);
-                }
+            // ...to see if one matches the current character.
+            if (t->trigger_char == c) {
+                add_state_to_set(run, t->target_state);
             }
         }
+    }
+    finish_step(run);
+}
 
-        // wap: The next_states become the current_states for the next loop.
-        memcpy(current_states, next_states, next_count * sizeof(State*));
-        current_count = next_count;
+/**
+ * @brief Checks if any of the states we are in is an accepting state
+ */
+static int run_accepts(const NfaRun* run) {
+    for (int i = 0; i < run->current_count; i++) {
+        if (run->current[i]->is_accepting) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// --- Public Facing Simulator Functions ---
+
+NfaRun* create_nfa_run(Nfa* nfa, const NfaStats* stats) {
+    NfaStats measured;
+    if (stats == NULL) {
+        if (measure_nfa(nfa, &measured) != 0) {
+            perror("Failed to measure NFA");
+            return NULL;
+        }
+        stats = &measured;
+    }
+
+    NfaRun* run = (NfaRun*)calloc(1, sizeof(NfaRun));
+    if (!run) {
+        perror("Failed to allocate NfaRun");
+        return NULL;
+    }
+    run->nfa = nfa;
+    run->num_stamps = stats->max_id - stats->min_id + 1;
+    run->current = (State**)malloc(stats->num_states * sizeof(State*));
+    run->next = (State**)malloc(stats->num_states * sizeof(State*));
+    run->stamps = (int*)calloc(run->num_stamps, sizeof(int));
+    if (!run->current || !run->next || !run->stamps) {
+        perror("Failed to allocate NFA state sets");
+        free_nfa_run(run);
+        return NULL;
+    }
+    run->min_id = stats->min_id;
+    run->follow_epsilon = !nfa->is_epsilon_free;
+    return run;
+}
+
+void free_nfa_run(NfaRun* run) {
+    if (!run) return;
+    free(run->current);
+    free(run->next);
+    free(run->stamps);
+    free(run);
+}
+
+int simulate_nfa(Nfa* nfa, const char* str) {
+    NfaRun* run = create_nfa_run(nfa, NULL);
+    if (!run) {
+        return 0;
+    }
+    int is_match = simulate_nfa_run(run, str);
+    free_nfa_run(run);
+    return is_match;
+}
+
+int simulate_nfa_run(NfaRun* run, const char* str) {
+    // current set starts with NFA's start state + epsilon closure.
+    start_run(run);
+
+    // loop through each character in the string
+    for (int i = 0; str[i] != '\0'; i++) {
+        step_run(run, str[i], 0);
 
         // Optimization: If at any point our current set is empty,
         // we can never reach an accept state.
-        if (current_count == 0) {
+        if (run->current_count == 0) {
             return 0; // No Match (dead end)
         }
     }
 
-    // 4. Final Check: After the string is exhausted, check if any
-    //    of the states we are in is an accepting state.
-    for (int i = 0; i < current_count; i++) {
-        if (current_states[i]->is_accepting) {
-            return 1; // Match!
+    // Final Check: After the string is exhausted, check if any
+    // of the states we are in is an accepting state.
+    return run_accepts(run);
+}
+
+int nfa_has_match(NfaRun* run, const char* text, size_t length) {
+    start_run(run);
+    int is_match = run_accepts(run);
+    for (size_t i = 0; !is_match && i < length; i++) {
+        step_run(run, text[i], 1);
+        is_match = run_accepts(run);
+    }
+    return is_match;
+}
+
+int search_nfa(NfaRun* forward, NfaRun* reverse, const char* str, int* match_start, int* match_end) {
+    // Pass 1: run the reversed NFA backward over the whole string,
+    // restarting at every position; the last accepting set marks the
+    // leftmost place a match starts
+    int length = (int)strlen(str);
+    start_run(reverse);
+    int start = run_accepts(reverse) ? length : -1;
+    for (int i = length - 1; i >= 0; i--) {
+        step_run(reverse, str[i], 1);
+        if (run_accepts(reverse)) {
+            start = i;
         }
     }
 
-    // If no current state is an accepting state, it's not a match.
-    return 0; // No Match
-}
\ No newline at end of file
+    if (start < 0) {
+        return 0; // No Match anywhere in the string
+    }
+
+    // Pass 2: run the forward NFA from that start; every accepting set
+    // we pass marks a valid end, and the longest match wins.
+    start_run(forward);
+    int end = run_accepts(forward) ? start : -1;
+    for (int i = start; str[i] != '\0' && forward->current_count > 0; i++) {
+        step_run(forward, str[i], 0);
+        if (run_accepts(forward)) {
+            end = i + 1;
+        }
+    }
+
+    *match_start = start;
+    *match_end = end;
+    return end >= 0;
+}
@@ -0,0 +1,810 @@
+#include "trigram.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_BLOCK_SIZE (64 * 1024)
+#define TRIGRAM_SPACE (1u << 24)        // Every possible three-byte sequence
+
+#define HEADER_SIZE 32
+#define FILE_ENTRY_SIZE 16
+#define BLOCK_ENTRY_SIZE 24
+#define TRIGRAM_ENTRY_SIZE 12
+
+static const char INDEX_MAGIC[4] = { 'T', 'R', 'G', '1' };
+
+// --- Little-Endian Encoding ---
+
+/**
+ * @struct ByteBuffer
+ * @brief A growable byte array the index sections are assembled in.
+ */
+typedef struct ByteBuffer {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+    int failed;         // Set once an allocation fails; later writes are dropped
+} ByteBuffer;
+
+static void put_bytes(ByteBuffer* buffer, const void* bytes, size_t count) {
+    if (buffer->failed) return;
+    if (buffer->length + count > buffer->capacity) {
+        size_t new_capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+        while (new_capacity < buffer->length + count) new_capacity *= 2;
+        unsigned char* grown = (unsigned char*)realloc(buffer->data, new_capacity);
+        if (!grown) {
+            perror("Failed to grow index buffer");
+            buffer->failed = 1;
+            return;
+        }
+        buffer->data = grown;
+        buffer->capacity = new_capacity;
+    }
+    memcpy(buffer->data + buffer->length, bytes, count);
+    buffer->length += count;
+}
+
+static void put_u32(ByteBuffer* buffer, unsigned long value) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++) bytes[i] = (unsigned char)(value >> (8 * i));
+    put_bytes(buffer, bytes, 4);
+}
+
+static void put_u64(ByteBuffer* buffer, unsigned long long value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) bytes[i] = (unsigned char)(value >> (8 * i));
+    put_bytes(buffer, bytes, 8);
+}
+
+static void put_varint(ByteBuffer* buffer, unsigned long value) {
+    unsigned char bytes[5];
+    int count = 0;
+    do {
+        bytes[count] = (unsigned char)(value & 0x7F);
+        value >>= 7;
+        if (value) bytes[count] |= 0x80;
+        count++;
+    } while (value);
+    put_bytes(buffer, bytes, count);
+}
+
+static unsigned int get_u32(const unsigned char* bytes) {
+    return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) |
+           ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+static unsigned long long get_u64(const unsigned char* bytes) {
+    return (unsigned long long)get_u32(bytes) | ((unsigned long long)get_u32(bytes + 4) << 32);
+}
+
+// --- Index Builder ---
+
+/**
+ * @struct IndexBuilder
+ * @brief Everything build_trigram_index() accumulates before writing.
+ */
+typedef struct IndexBuilder {
+    size_t block_size;
+    ByteBuffer files;
+    ByteBuffer blocks;
+    ByteBuffer strings;
+    unsigned int num_files;
+    unsigned int num_blocks;
+
+    unsigned char* seen;            // Bitmap over TRIGRAM_SPACE for the current block
+    unsigned int* block_trigrams;   // The trigrams set in 'seen', to clear it again
+    size_t num_block_trigrams;
+    size_t max_block_trigrams;
+
+    unsigned long long* pairs;      // (trigram << 32) | block, one per distinct trigram per block
+    size_t num_pairs;
+    size_t max_pairs;
+    int failed;
+} IndexBuilder;
+
+static int grow_array(void** array, size_t* capacity, size_t element_size, const char* what) {
+    size_t new_capacity = *capacity ? *capacity * 2 : 1024;
+    void* grown = realloc(*array, new_capacity * element_size);
+    if (!grown) {
+        perror(what);
+        return -1;
+    }
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * @brief Records the distinct trigrams of one block.
+ * Trigrams that cross a newline are skipped: matching is line by line, so
+ * no query ever needs them.
+ */
+static void index_block(IndexBuilder* builder, const unsigned char* data, size_t length) {
+    builder->num_block_trigrams = 0;
+
+    for (size_t i = 0; i + 2 < length; i++) {
+        if (data[i] == '\n' || data[i + 1] == '\n' || data[i + 2] == '\n') continue;
+
+        unsigned int trigram = ((unsigned int)data[i] << 16) | ((unsigned int)data[i + 1] << 8) | data[i + 2];
+        if (builder->seen[trigram >> 3] & (1u << (trigram & 7))) continue;
+
+        if (builder->num_block_trigrams == builder->max_block_trigrams &&
+            grow_array((void**)&builder->block_trigrams, &builder->max_block_trigrams,
+                       sizeof(unsigned int), "Failed to grow block trigrams") != 0) {
+            builder->failed = 1;
+            break;
+        }
+        builder->seen[trigram >> 3] |= (unsigned char)(1u << (trigram & 7));
+        builder->block_trigrams[builder->num_block_trigrams++] = trigram;
+    }
+
+    for (size_t i = 0; i < builder->num_block_trigrams; i++) {
+        unsigned int trigram = builder->block_trigrams[i];
+        builder->seen[trigram >> 3] = 0; // Reset the bitmap for the next block
+
+        if (builder->num_pairs == builder->max_pairs &&
+            grow_array((void**)&builder->pairs, &builder->max_pairs,
+                       sizeof(unsigned long long), "Failed to grow trigram postings") != 0) {
+            builder->failed = 1;
+            return;
+        }
+        builder->pairs[builder->num_pairs++] = ((unsigned long long)trigram << 32) | builder->num_blocks;
+    }
+}
+
+static void index_file(IndexBuilder* builder, const char* path) {
+    MappedFile file;
+    if (map_file(path, &file) != 0) {
+        fprintf(stderr, "Error: Cannot read '%s'.\n", path);
+        return;
+    }
+
+    unsigned int file_id = builder->num_files++;
+    put_u32(&builder->files, builder->strings.length);
+    put_u32(&builder->files, 0);
+    put_u64(&builder->files, file.length);
+    put_bytes(&builder->strings, path, strlen(path) + 1);
+
+    // Blocks end on line boundaries, like grep_paths() chunks, so every
+    // line lives in exactly one block.
+    const char* data = file.data;
+    size_t begin = 0;
+    unsigned long long line = 0;
+    while (begin < file.length && !builder->failed) {
+        size_t end = file.length;
+        if (file.length - begin > builder->block_size) {
+            const char* newline = (const char*)memchr(data + begin + builder->block_size, '\n',
+                                                      file.length - begin - builder->block_size);
+            if (newline) end = (size_t)(newline - data) + 1;
+        }
+
+        index_block(builder, (const unsigned char*)data + begin, end - begin);
+        put_u32(&builder->blocks, file_id);
+        put_u32(&builder->blocks, end - begin);
+        put_u64(&builder->blocks, begin);
+        put_u64(&builder->blocks, line);
+        builder->num_blocks++;
+
+        for (const char* p = data + begin; (p = (const char*)memchr(p, '\n', data + end - p)) != NULL; p++) {
+            line++;
+        }
+        begin = end;
+    }
+
+    unmap_file(&file);
+}
+
+static void add_path(IndexBuilder* builder, const char* path) {
+    if (!is_directory(path)) {
+        index_file(builder, path);
+        return;
+    }
+
+    char** names = NULL;
+    int num_names = 0;
+    if (list_directory(path, &names, &num_names) != 0) {
+        fprintf(stderr, "Error: Cannot list directory '%s'.\n", path);
+        return;
+    }
+    for (int i = 0; i < num_names; i++) {
+        char* child = join_path(path, names[i]);
+        if (child) {
+            add_path(builder, child);
+            free(child);
+        }
+        free(names[i]);
+    }
+    free(names);
+}
+
+static int compare_pairs(const void* a, const void* b) {
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+int build_trigram_index(char* const* paths, int num_paths, const char* index_path, size_t block_size) {
+    IndexBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.block_size = block_size ? block_size : DEFAULT_BLOCK_SIZE;
+    builder.seen = (unsigned char*)calloc(TRIGRAM_SPACE / 8, 1);
+    if (!builder.seen) {
+        perror("Failed to allocate trigram bitmap");
+        return -1;
+    }
+
+    for (int i = 0; i < num_paths && !builder.failed; i++) {
+        add_path(&builder, paths[i]);
+    }
+
+    // Group the (trigram, block) pairs by trigram; blocks stay ascending
+    qsort(builder.pairs, builder.num_pairs, sizeof(unsigned long long), compare_pairs);
+
+    ByteBuffer trigrams = { 0 };
+    ByteBuffer postings = { 0 };
+    unsigned int num_trigrams = 0;
+    for (size_t i = 0; i < builder.num_pairs;) {
+        unsigned int trigram = (unsigned int)(builder.pairs[i] >> 32);
+        size_t first = i;
+        unsigned long previous = 0;
+
+        put_u32(&trigrams, trigram);
+        size_t count_at = trigrams.length;
+        put_u32(&trigrams, 0); // Patched below once the count is known
+        put_u32(&trigrams, postings.length);
+
+        for (; i < builder.num_pairs && (unsigned int)(builder.pairs[i] >> 32) == trigram; i++) {
+            unsigned long block = (unsigned long)(builder.pairs[i] & 0xFFFFFFFFu);
+            put_varint(&postings, block - previous);
+            previous = block;
+        }
+        if (!trigrams.failed) {
+            unsigned long count = (unsigned long)(i - first);
+            for (int b = 0; b < 4; b++) trigrams.data[count_at + b] = (unsigned char)(count >> (8 * b));
+        }
+        num_trigrams++;
+    }
+
+    int result = -1;
+    if (!builder.failed && !builder.files.failed && !builder.blocks.failed &&
+        !builder.strings.failed && !trigrams.failed && !postings.failed) {
+        ByteBuffer header = { 0 };
+        put_bytes(&header, INDEX_MAGIC, 4);
+        put_u32(&header, builder.num_files);
+        put_u32(&header, builder.num_blocks);
+        put_u32(&header, num_trigrams);
+        put_u32(&header, builder.block_size);
+        put_u32(&header, postings.length);
+        put_u32(&header, builder.strings.length);
+        put_u32(&header, 0);
+
+        FILE* out = fopen(index_path, "wb");
+        if (out == NULL) {
+            perror("Failed to create index file");
+        } else {
+            ByteBuffer* sections[] = { &header, &builder.files, &builder.blocks,
+                                       &trigrams, &postings, &builder.strings };
+            result = 0;
+            for (int s = 0; s < 6; s++) {
+                if (sections[s]->length > 0 &&
+                    fwrite(sections[s]->data, 1, sections[s]->length, out) != sections[s]->length) {
+                    result = -1;
+                }
+            }
+            if (fclose(out) != 0) result = -1;
+            if (result != 0) perror("Failed to write index file");
+        }
+        free(header.data);
+    }
+
+    free(builder.seen);
+    free(builder.block_trigrams);
+    free(builder.pairs);
+    free(builder.files.data);
+    free(builder.blocks.data);
+    free(builder.strings.data);
+    free(trigrams.data);
+    free(postings.data);
+    return result;
+}
+
+// --- Index Reader ---
+
+/**
+ * @brief Checks that every table entry points inside the index.
+ * Posting lists themselves are checked as they are decoded.
+ * @return 1 if the tables are consistent, 0 if the index is corrupt.
+ */
+static int validate_tables(const TrigramIndex* index, size_t strings_size) {
+    // Paths must be null-terminated inside the strings section
+    if (index->num_files > 0 && (strings_size == 0 || index->strings[strings_size - 1] != '\0')) {
+        return 0;
+    }
+    for (unsigned int f = 0; f < index->num_files; f++) {
+        if (get_u32(index->files + (size_t)f * FILE_ENTRY_SIZE) >= strings_size) return 0;
+    }
+
+    for (unsigned int b = 0; b < index->num_blocks; b++) {
+        const unsigned char* block = index->blocks + (size_t)b * BLOCK_ENTRY_SIZE;
+        unsigned int file_id = get_u32(block);
+        if (file_id >= index->num_files) return 0;
+
+        // The block must lie inside the file as it was indexed
+        unsigned long long file_size = get_u64(index->files + (size_t)file_id * FILE_ENTRY_SIZE + 8);
+        unsigned long long block_length = get_u32(block + 4);
+        unsigned long long offset = get_u64(block + 8);
+        if (block_length > file_size || offset > file_size - block_length) return 0;
+    }
+
+    for (unsigned int t = 0; t < index->num_trigrams; t++) {
+        const unsigned char* entry = index->trigrams + (size_t)t * TRIGRAM_ENTRY_SIZE;
+        if (t > 0 && get_u32(entry) <= get_u32(entry - TRIGRAM_ENTRY_SIZE)) return 0; // Must stay sorted
+
+        // Every posting takes at least one byte
+        unsigned int count = get_u32(entry + 4);
+        unsigned int offset = get_u32(entry + 8);
+        if (offset > index->postings_size || count > index->postings_size - offset) return 0;
+    }
+    return 1;
+}
+
+TrigramIndex* open_trigram_index(const char* index_path) {
+    TrigramIndex* index = (TrigramIndex*)calloc(1, sizeof(TrigramIndex));
+    if (!index) {
+        perror("Failed to allocate TrigramIndex");
+        return NULL;
+    }
+    if (map_file(index_path, &index->file) != 0) {
+        fprintf(stderr, "Error: Cannot read index '%s'.\n", index_path);
+        free(index);
+        return NULL;
+    }
+
+    const unsigned char* data = (const unsigned char*)index->file.data;
+    size_t length = index->file.length;
+    if (length < HEADER_SIZE || memcmp(data, INDEX_MAGIC, 4) != 0) {
+        fprintf(stderr, "Error: '%s' is not a trigram index.\n", index_path);
+        close_trigram_index(index);
+        return NULL;
+    }
+
+    index->num_files = get_u32(data + 4);
+    index->num_blocks = get_u32(data + 8);
+    index->num_trigrams = get_u32(data + 12);
+    unsigned long long postings_size = get_u32(data + 20);
+    unsigned long long strings_size = get_u32(data + 24);
+
+    unsigned long long expected = HEADER_SIZE +
+        (unsigned long long)index->num_files * FILE_ENTRY_SIZE +
+        (unsigned long long)index->num_blocks * BLOCK_ENTRY_SIZE +
+        (unsigned long long)index->num_trigrams * TRIGRAM_ENTRY_SIZE +
+        postings_size + strings_size;
+    if (expected != length) {
+        fprintf(stderr, "Error: Index '%s' is truncated or corrupt.\n", index_path);
+        close_trigram_index(index);
+        return NULL;
+    }
+
+    index->files = data + HEADER_SIZE;
+    index->blocks = index->files + (size_t)index->num_files * FILE_ENTRY_SIZE;
+    index->trigrams = index->blocks + (size_t)index->num_blocks * BLOCK_ENTRY_SIZE;
+    index->postings = index->trigrams + (size_t)index->num_trigrams * TRIGRAM_ENTRY_SIZE;
+    index->strings = (const char*)(index->postings + postings_size);
+    index->postings_size = (size_t)postings_size;
+    if (!validate_tables(index, (size_t)strings_size)) {
+        fprintf(stderr, "Error: Index '%s' is truncated or corrupt.\n", index_path);
+        close_trigram_index(index);
+        return NULL;
+    }
+    return index;
+}
+
+void close_trigram_index(TrigramIndex* index) {
+    if (!index) return;
+    unmap_file(&index->file);
+    free(index);
+}
+
+// --- Query Planner ---
+
+static TrigramQuery* create_query(TrigramQueryType type) {
+    TrigramQuery* query = (TrigramQuery*)calloc(1, sizeof(TrigramQuery));
+    if (!query) {
+        perror("Failed to allocate TrigramQuery");
+    }
+    if (query) query->type = type;
+    return query;
+}
+
+static int add_child(TrigramQuery* parent, TrigramQuery* child) {
+    TrigramQuery** grown = (TrigramQuery**)realloc(parent->children,
+                                                    (parent->num_children + 1) * sizeof(TrigramQuery*));
+    if (!grown) {
+        perror("Failed to grow TrigramQuery");
+        return -1;
+    }
+    parent->children = grown;
+    parent->children[parent->num_children++] = child;
+    return 0;
+}
+
+static int same_query(const TrigramQuery* a, const TrigramQuery* b) {
+    if (a->type != b->type || a->num_children != b->num_children) return 0;
+    if (a->type == QUERY_TRIGRAM) return a->trigram == b->trigram;
+    for (int i = 0; i < a->num_children; i++) {
+        if (!same_query(a->children[i], b->children[i])) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds 'child' to an AND/OR node, keeping the query small:
+ * nested nodes of the same type are flattened, duplicates dropped, and
+ * QUERY_ALL is absorbed (AND) or marks the whole node (OR).
+ * @return 0 on success, 1 if an OR just became QUERY_ALL, -1 on failure.
+ */
+static int combine(TrigramQuery* parent, TrigramQuery* child) {
+    if (child->type == QUERY_ALL) {
+        free_trigram_query(child);
+        return parent->type == QUERY_OR ? 1 : 0;
+    }
+    if (child->type == parent->type) {
+        for (int i = 0; i < child->num_children; i++) {
+            int status = combine(parent, child->children[i]);
+            child->children[i] = NULL;
+            if (status != 0) {
+                for (int j = i + 1; j < child->num_children; j++) free_trigram_query(child->children[j]);
+                child->num_children = 0;
+                free_trigram_query(child);
+                return status;
+            }
+        }
+        child->num_children = 0;
+        free_trigram_query(child);
+        return 0;
+    }
+    for (int i = 0; i < parent->num_children; i++) {
+        if (same_query(parent->children[i], child)) {
+            free_trigram_query(child);
+            return 0;
+        }
+    }
+    if (add_child(parent, child) != 0) {
+        free_trigram_query(child);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Collapses an AND/OR with zero or one children.
+ */
+static TrigramQuery* finish(TrigramQuery* query) {
+    if (query->num_children == 0) {
+        free_trigram_query(query);
+        return create_query(QUERY_ALL);
+    }
+    if (query->num_children == 1) {
+        TrigramQuery* only = query->children[0];
+        query->num_children = 0;
+        free_trigram_query(query);
+        return only;
+    }
+    return query;
+}
+
+static TrigramQuery* plan_literal(const char* text, int length) {
+    TrigramQuery* query = create_query(QUERY_AND);
+    if (!query) return NULL;
+
+    for (int i = 0; i + 2 < length; i++) {
+        TrigramQuery* trigram = create_query(QUERY_TRIGRAM);
+        if (!trigram) {
+            free_trigram_query(query);
+            return NULL;
+        }
+        trigram->trigram = ((unsigned int)(unsigned char)text[i] << 16) |
+                           ((unsigned int)(unsigned char)text[i + 1] << 8) |
+                           (unsigned char)text[i + 2];
+        if (combine(query, trigram) < 0) {
+            free_trigram_query(query);
+            return NULL;
+        }
+    }
+    return finish(query);
+}
+
+TrigramQuery* plan_trigram_query(const RegexNode* node) {
+    switch (node->type) {
+        case REGEX_LITERAL:
+            return plan_literal(node->text, node->text_length);
+
+        case REGEX_CLASS:
+        case REGEX_STAR:
+            return create_query(QUERY_ALL); // Could match almost anything
+
+        case REGEX_CONCAT:
+        case REGEX_UNION: {
+            TrigramQuery* query = create_query(node->type == REGEX_CONCAT ? QUERY_AND : QUERY_OR);
+            if (!query) return NULL;
+
+            for (int i = 0; i < node->num_children; i++) {
+                TrigramQuery* child = plan_trigram_query(node->children[i]);
+                int status = child ? combine(query, child) : -1;
+                if (status < 0) {
+                    free_trigram_query(query);
+                    return NULL;
+                }
+                if (status == 1) {
+                    // One alternative needs no trigram, so neither does the union
+                    free_trigram_query(query);
+                    return create_query(QUERY_ALL);
+                }
+            }
+            return finish(query);
+        }
+    }
+    return NULL;
+}
+
+void print_trigram_query(const TrigramQuery* query, FILE* out) {
+    switch (query->type) {
+        case QUERY_ALL:
+            fprintf(out, "*");
+            break;
+        case QUERY_TRIGRAM:
+            fputc('"', out);
+            for (int shift = 16; shift >= 0; shift -= 8) {
+                unsigned char c = (unsigned char)(query->trigram >> shift);
+                if (c >= 32 && c < 127 && c != '"' && c != '\\') fputc(c, out);
+                else fprintf(out, "\\x%02X", c);
+            }
+            fputc('"', out);
+            break;
+        case QUERY_AND:
+        case QUERY_OR:
+            fputc('(', out);
+            for (int i = 0; i < query->num_children; i++) {
+                if (i > 0) fprintf(out, query->type == QUERY_AND ? " AND " : " OR ");
+                print_trigram_query(query->children[i], out);
+            }
+            fputc(')', out);
+            break;
+    }
+}
+
+void free_trigram_query(TrigramQuery* query) {
+    if (!query) return;
+    for (int i = 0; i < query->num_children; i++) {
+        free_trigram_query(query->children[i]);
+    }
+    free(query->children);
+    free(query);
+}
+
+// --- Query Evaluation ---
+
+/**
+ * @struct BlockSet
+ * @brief A sorted set of block ids, or every block.
+ */
+typedef struct BlockSet {
+    int all;
+    unsigned int* ids;
+    unsigned int count;
+} BlockSet;
+
+/**
+ * @brief Looks up one trigram's posting list with a binary search.
+ */
+static int lookup_trigram(TrigramIndex* index, unsigned int trigram, BlockSet* set) {
+    set->all = 0;
+    set->ids = NULL;
+    set->count = 0;
+
+    unsigned int low = 0, high = index->num_trigrams;
+    while (low < high) {
+        unsigned int mid = low + (high - low) / 2;
+        unsigned int value = get_u32(index->trigrams + (size_t)mid * TRIGRAM_ENTRY_SIZE);
+        if (value < trigram) low = mid + 1;
+        else high = mid;
+    }
+    const unsigned char* entry = index->trigrams + (size_t)low * TRIGRAM_ENTRY_SIZE;
+    if (low == index->num_trigrams || get_u32(entry) != trigram) {
+        return 0; // No block contains it
+    }
+
+    unsigned int count = get_u32(entry + 4);
+    set->ids = (unsigned int*)malloc(count * sizeof(unsigned int));
+    if (!set->ids) {
+        perror("Failed to allocate posting list");
+        return -1;
+    }
+
+    // Offsets were checked when the index was opened, but the varints
+    // themselves could still run off the end or name a missing block
+    const unsigned char* p = index->postings + get_u32(entry + 8);
+    const unsigned char* postings_end = index->postings + index->postings_size;
+    unsigned int block = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        unsigned int delta = 0;
+        int shift = 0;
+        int more = 1;
+        while (more && p < postings_end && shift < 32) {
+            delta |= (unsigned int)(*p & 0x7F) << shift;
+            shift += 7;
+            more = *p++ & 0x80;
+        }
+        // Ids ascend, so every delta after the first is positive
+        if (more || (i > 0 && delta == 0) || delta >= index->num_blocks - block) {
+            fprintf(stderr, "Error: Trigram index is corrupt.\n");
+            free(set->ids);
+            set->ids = NULL;
+            return -1;
+        }
+        block += delta;
+        set->ids[i] = block;
+    }
+    set->count = count;
+    return 0;
+}
+
+/**
+ * @brief Merges 'other' into 'set' (intersection or union); frees 'other'.
+ */
+static int merge_sets(BlockSet* set, BlockSet* other, int intersect) {
+    if (intersect && other->all) {
+        return 0;           // set AND all = set
+    }
+    if (intersect && set->all) {
+        *set = *other;      // all AND other = other
+        return 0;
+    }
+    if (!intersect && set->all) {
+        free(other->ids);   // all OR other = all
+        return 0;
+    }
+    if (!intersect && other->all) {
+        free(set->ids);     // set OR all = all
+        *set = *other;
+        return 0;
+    }
+
+    unsigned int max = intersect ? (set->count < other->count ? set->count : other->count)
+                                 : set->count + other->count;
+    unsigned int* merged = (unsigned int*)malloc((max ? max : 1) * sizeof(unsigned int));
+    if (!merged) {
+        perror("Failed to merge posting lists");
+        free(other->ids);
+        return -1;
+    }
+
+    unsigned int i = 0, j = 0, n = 0;
+    while (i < set->count && j < other->count) {
+        if (set->ids[i] == other->ids[j]) {
+            merged[n++] = set->ids[i++];
+            j++;
+        } else if (set->ids[i] < other->ids[j]) {
+            if (!intersect) merged[n++] = set->ids[i];
+            i++;
+        } else {
+            if (!intersect) merged[n++] = other->ids[j];
+            j++;
+        }
+    }
+    if (!intersect) {
+        while (i < set->count) merged[n++] = set->ids[i++];
+        while (j < other->count) merged[n++] = other->ids[j++];
+    }
+
+    free(set->ids);
+    free(other->ids);
+    set->ids = merged;
+    set->count = n;
+    return 0;
+}
+
+static int evaluate_query(TrigramIndex* index, const TrigramQuery* query, BlockSet* set) {
+    switch (query->type) {
+        case QUERY_ALL:
+            set->all = 1;
+            set->ids = NULL;
+            set->count = 0;
+            return 0;
+
+        case QUERY_TRIGRAM:
+            return lookup_trigram(index, query->trigram, set);
+
+        case QUERY_AND:
+        case QUERY_OR: {
+            int intersect = query->type == QUERY_AND;
+            set->all = intersect; // The identity: everything for AND, nothing for OR
+            set->ids = NULL;
+            set->count = 0;
+
+            for (int i = 0; i < query->num_children; i++) {
+                if (intersect && !set->all && set->count == 0) break; // Already empty
+                BlockSet child;
+                if (evaluate_query(index, query->children[i], &child) != 0 ||
+                    merge_sets(set, &child, intersect) != 0) {
+                    free(set->ids);
+                    return -1;
+                }
+            }
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// --- Search ---
+
+long search_trigram_index(TrigramIndex* index, const TrigramQuery* query, const EnginePlan* plan,
+                          FILE* out, unsigned int* num_candidates) {
+    BlockSet candidates;
+    if (evaluate_query(index, query, &candidates) != 0) {
+        return -1;
+    }
+    unsigned int count = candidates.all ? index->num_blocks : candidates.count;
+    *num_candidates = count;
+
+    NfaRun* run = create_plan_run(plan); // Reused for every line of the scan
+    if (run == NULL && plan_needs_run(plan)) {
+        free(candidates.ids);
+        return -1;
+    }
+
+    long total = 0;
+    MappedFile file = { "", 0, NULL };
+    unsigned int mapped_file = (unsigned int)-1;
+    int file_usable = 0;
+
+    // Candidates are sorted, and blocks are numbered in file order, so each
+    // file is mapped once and only its candidate blocks are touched
+    for (unsigned int c = 0; c < count; c++) {
+        unsigned int block_id = candidates.all ? c : candidates.ids[c];
+        const unsigned char* block = index->blocks + (size_t)block_id * BLOCK_ENTRY_SIZE;
+        unsigned int file_id = get_u32(block);
+        const unsigned char* entry = index->files + (size_t)file_id * FILE_ENTRY_SIZE;
+        const char* path = index->strings + get_u32(entry);
+
+        if (file_id != mapped_file) {
+            unmap_file(&file);
+            mapped_file = file_id;
+            file_usable = 0;
+            if (map_file(path, &file) != 0) {
+                fprintf(stderr, "Error: Cannot read '%s'.\n", path);
+            } else if (file.length != get_u64(entry + 8)) {
+                fprintf(stderr, "Warning: '%s' changed since it was indexed; skipping it.\n", path);
+            } else {
+                file_usable = 1;
+            }
+        }
+        if (!file_usable) continue;
+
+        size_t begin = (size_t)get_u64(block + 8);
+        size_t end = begin + get_u32(block + 4);
+        unsigned long long line = get_u64(block + 16);
+
+        size_t line_start = begin;
+        while (line_start < end) {
+            const char* newline = (const char*)memchr(file.data + line_start, '\n', end - line_start);
+            size_t line_end = newline ? (size_t)(newline - file.data) : end;
+
+            if (plan_has_match(plan, run, file.data + line_start, line_end - line_start)) {
+                fprintf(out, "%s:%llu:", path, line + 1);
+                fwrite(file.data + line_start, 1, line_end - line_start, out);
+                fputc('\n', out);
+                total++;
+            }
+
+            if (newline == NULL) break;
+            line++;
+            line_start = line_end + 1;
+        }
+    }
+
+    unmap_file(&file);
+    free_nfa_run(run);
+    free(candidates.ids);
+    return total;
+}
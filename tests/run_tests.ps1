@@ -58,13 +58,116 @@ $testCases = @(
     @{ Pattern = "((a|b)*)c"; String = "abababc"; Expected = "Match" },
     @{ Pattern = "a*b*c*"; String = "aaabbc"; Expected = "Match" },
     @{ Pattern = "a*b*c*"; String = "c"; Expected = "Match" }, # Zero a's and zero b's
-    @{ Pattern = "a*b*c*"; String = "aaacbb"; Expected = "NoMatch" } # Order violation
+    @{ Pattern = "a*b*c*"; String = "aaacbb"; Expected = "NoMatch" }, # Order violation
+
+    # Group 8: Syntax tree rewrites
+    # These patterns are simplified before any automaton is built
+    @{ Pattern = "(a*)*"; String = "aaa"; Expected = "Match" },
+    @{ Pattern = "(a*b*)*"; String = "abba"; Expected = "Match" },
+    @{ Pattern = "(a*b*)*"; String = "abca"; Expected = "NoMatch" },
+    @{ Pattern = "a|a|b"; String = "b"; Expected = "Match" },
+    @{ Pattern = "abc|abd"; String = "abd"; Expected = "Match" },
+    @{ Pattern = "abc|abd"; String = "ab"; Expected = "NoMatch" },
+    @{ Pattern = "a|ab|ac"; String = "a"; Expected = "Match" },
+    @{ Pattern = "xz|yz"; String = "yz"; Expected = "Match" },
+    @{ Pattern = "xz|yz"; String = "xy"; Expected = "NoMatch" },
+
+    # Group 9: Escapes and bracket classes
+    @{ Pattern = "[a-c]*"; String = "abcba"; Expected = "Match" },
+    @{ Pattern = "[a-c]*"; String = "abd"; Expected = "NoMatch" },
+    @{ Pattern = "[^a]b"; String = "xb"; Expected = "Match" },
+    @{ Pattern = "[^a]b"; String = "ab"; Expected = "NoMatch" },
+    @{ Pattern = "[a-z_][a-z0-9_]*"; String = "x_1"; Expected = "Match" },
+    @{ Pattern = "[a-z_][a-z0-9_]*"; String = "1x"; Expected = "NoMatch" },
+    @{ Pattern = "a\*b"; String = "a*b"; Expected = "Match" },
+    @{ Pattern = "a\*b"; String = "aab"; Expected = "NoMatch" },
+    @{ Pattern = "x[ ]y"; String = "x y"; Expected = "Match" }
+)
+
+# Substring search cases for --search (two-pass reverse/forward DFA).
+# Span is the [start, end) the engine should report for a match.
+$searchTestCases = @(
+    @{ Pattern = "ab"; String = "xxabyy"; Expected = "Match"; Span = "[2, 4)" },
+    @{ Pattern = "b*c"; String = "aabbbcd"; Expected = "Match"; Span = "[2, 6)" },
+    @{ Pattern = "(a|b)*c"; String = "zzabacz"; Expected = "Match"; Span = "[2, 6)" },
+    @{ Pattern = "abcd|c"; String = "abcd"; Expected = "Match"; Span = "[0, 4)" }, # Leftmost start wins
+    @{ Pattern = "b|abc"; String = "abc"; Expected = "Match"; Span = "[0, 3)" },
+    @{ Pattern = "ab|abcd"; String = "xabcd"; Expected = "Match"; Span = "[1, 5)" }, # Then the longest match
+    @{ Pattern = "a*"; String = "baa"; Expected = "Match"; Span = "[0, 0)" }, # Empty match at the start
+    @{ Pattern = "xy"; String = "abcxay"; Expected = "NoMatch"; Span = "" }
+)
+
+# Boolean combinator cases (single product DFA).
+# ArgList holds the combinator flag and its second pattern, if any.
+$productTestCases = @(
+    @{ ArgList = @("--and", "(a|b)*c"); Pattern = "a*bc"; String = "abc"; Expected = "Match" },
+    @{ ArgList = @("--and", "(a|b)*c"); Pattern = "a*bc"; String = "bbc"; Expected = "NoMatch" },
+    @{ ArgList = @("--and-not", "a*bc"); Pattern = "(a|b)*c"; String = "bac"; Expected = "Match" },
+    @{ ArgList = @("--and-not", "a*bc"); Pattern = "(a|b)*c"; String = "aabc"; Expected = "NoMatch" },
+    @{ ArgList = @("--not"); Pattern = "ab"; String = "abc"; Expected = "Match" },
+    @{ ArgList = @("--not"); Pattern = "ab"; String = ""; Expected = "Match" },
+    @{ ArgList = @("--not"); Pattern = "ab"; String = "ab"; Expected = "NoMatch" }
+)
+
+# Lexer cases for --lex: tokenize a sample file.
+# Tokens is the count the lexer should report (including TOKEN_EOF).
+$lexerTestCases = @(
+    @{ File = "samples\program.det"; Expected = "Match"; Tokens = "24" },
+    @{ File = "samples\bad.det"; Expected = "NoMatch"; Tokens = "8" } # '@' is a TOKEN_ERROR
+)
+
+# Multi-file grep cases for --grep: search a directory tree.
+# Lines is the number of matching lines; Last is how the final one ends,
+# which checks that output comes in sorted file order.
+$grepTestCases = @(
+    @{ Pattern = "error"; Path = "samples\logs"; Expected = "Match"; Lines = "4"; Last = ":3:error deadlock" },
+    @{ Pattern = "query|boot"; Path = "samples\logs"; Expected = "Match"; Lines = "3"; Last = ":2:slow query" },
+    @{ Pattern = "error|query|timeout|shutdown|overflow|segfault|heartbeat|checkpoint|rollback"; Path = "samples\logs"; Expected = "Match"; Lines = "7"; Last = ":3:error deadlock" }, # Aho-Corasick
+    @{ Pattern = "panic"; Path = "samples\logs"; Expected = "NoMatch"; Lines = "0"; Last = "" }
+)
+
+# Indexed search cases for --indexed-grep, run against an index of samples\logs.
+# Candidates is how many of the index's blocks the trigram query leaves to scan.
+$indexTestCases = @(
+    @{ Pattern = "deadlock"; Expected = "Match"; Lines = "1"; Candidates = "1" },
+    @{ Pattern = "error[ ](disk|old)"; Expected = "Match"; Lines = "2"; Candidates = "2" },
+    @{ Pattern = "q*uery"; Expected = "Match"; Lines = "2"; Candidates = "1" },
+    @{ Pattern = "panic"; Expected = "NoMatch"; Lines = "0"; Candidates = "0" }
+)
+
+# Keyword list cases: a literal alternation too long for the bit-parallel
+# engine, which should take the Aho-Corasick path. Span is checked as above.
+$keywordPattern = (1..2000 | ForEach-Object { "word$_" }) -join "|"
+$keywordTestCases = @(
+    @{ ArgList = @(); String = "word1999"; Expected = "Match"; Span = "" },
+    @{ ArgList = @(); String = "word2001"; Expected = "NoMatch"; Span = "" },
+    @{ ArgList = @(); String = "word"; Expected = "NoMatch"; Span = "" }, # A prefix of every keyword
+    @{ ArgList = @("--search"); String = "xxword77yy"; Expected = "Match"; Span = "[2, 8)" }, # "word77" is longer than "word7"
+    @{ ArgList = @("--search"); String = "words"; Expected = "NoMatch"; Span = "" }
+)
+
+# Engine planner cases: Engine is the engine the planner should pick.
+# The blow-up pattern ("an 'a' 41st from the end") needs about 2^41 DFA
+# states, so subset construction runs out of budget and the NFA takes over.
+$blowupPattern = "(a|b)*a" + ("(a|b)" * 40)
+$longPattern = "(" + ("abcdefgh" * 9) + ")*"
+$plannerTestCases = @(
+    @{ ArgList = @(); Pattern = "ab*c"; String = "abbc"; Expected = "Match"; Engine = "Shift-And" },
+    @{ ArgList = @(); Pattern = $longPattern; String = ("abcdefgh" * 18); Expected = "Match"; Engine = "DFA" }, # 72 positions
+    @{ ArgList = @("--search"); Pattern = "ab*c"; String = "xabbcx"; Expected = "Match"; Engine = "DFA" },
+    @{ ArgList = @("--dfa-budget", "2", "--search"); Pattern = "ab*c"; String = "xabbcx"; Expected = "Match"; Engine = "NFA" }, # Estimate over budget
+    @{ ArgList = @(); Pattern = $blowupPattern; String = ("bbbbba" + ("ab" * 20)); Expected = "Match"; Engine = "NFA" },
+    @{ ArgList = @(); Pattern = $blowupPattern; String = ("b" * 46); Expected = "NoMatch"; Engine = "NFA" },
+    @{ ArgList = @("--search"); Pattern = $blowupPattern; String = ("xx" + ("ab" * 21)); Expected = "Match"; Engine = "NFA" }
 )
 
 # Define the modes we want to run
 $modes = @(
-    @{ Name = "NFA SIMULATION"; ArgList = @() },
-    @{ Name = "DFA SIMULATION"; ArgList = @("--dfa") }
+    @{ Name = "NFA SIMULATION"; ArgList = @("--nfa") },
+    @{ Name = "AUTO (BIT-PARALLEL) SIMULATION"; ArgList = @() },
+    @{ Name = "DFA SIMULATION"; ArgList = @("--dfa") },
+    @{ Name = "GLUSHKOV NFA SIMULATION"; ArgList = @("--glushkov", "--nfa") },
+    @{ Name = "GLUSHKOV DFA SIMULATION"; ArgList = @("--glushkov", "--dfa") }
 )
 
 # --- Run Tests Loop ---
@@ -100,8 +203,184 @@ foreach ($mode in $modes) {
     }
 }
 
+# --- Run Boolean Combinator Tests ---
+Write-Host ""
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host "  RUNNING PRODUCT DFA COMBINATORS" -ForegroundColor Cyan
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host ""
+
+foreach ($test in $productTestCases) {
+    $argsToRun = $test.ArgList + $test.Pattern + $test.String
+    & $executable $argsToRun > $null
+    $result = if ($LASTEXITCODE -eq 0) { "Match" } else { "NoMatch" }
+
+    if ($result -eq $test.Expected) {
+        Write-Host -ForegroundColor Green "  [PASS] $($test.ArgList -join ' ') '$($test.Pattern)' vs '$($test.String)' (Expected: $($test.Expected))"
+        $passCount++
+    } else {
+        Write-Host -ForegroundColor Red "  [FAIL] $($test.ArgList -join ' ') '$($test.Pattern)' vs '$($test.String)' (Expected: $($test.Expected), Got: $result)"
+        $failCount++
+    }
+}
+
+# --- Run Search Tests ---
+Write-Host ""
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host "  RUNNING DFA SEARCH" -ForegroundColor Cyan
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host ""
+
+foreach ($test in $searchTestCases) {
+    $output = & $executable "--search" $test.Pattern $test.String
+    $exitCode = $LASTEXITCODE
+
+    $result = if ($exitCode -eq 0) { "Match" } else { "NoMatch" }
+    $span = ""
+    foreach ($line in $output) {
+        if ($line -match '^Match span: (\[\d+, \d+\))') { $span = $Matches[1] }
+    }
+
+    if ($result -eq $test.Expected -and $span -eq $test.Span) {
+        Write-Host -ForegroundColor Green "  [PASS] '$($test.Pattern)' in '$($test.String)' (Expected: $($test.Expected) $($test.Span))"
+        $passCount++
+    } else {
+        Write-Host -ForegroundColor Red "  [FAIL] '$($test.Pattern)' in '$($test.String)' (Expected: $($test.Expected) $($test.Span), Got: $result $span)"
+        $failCount++
+    }
+}
+
+# --- Run Engine Planner Tests ---
+Write-Host ""
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host "  RUNNING ENGINE PLANNER" -ForegroundColor Cyan
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host ""
+
+foreach ($test in $plannerTestCases) {
+    $argsToRun = $test.ArgList + $test.Pattern + $test.String
+    $output = & $executable $argsToRun
+    $result = if ($LASTEXITCODE -eq 0) { "Match" } else { "NoMatch" }
+    $engine = ""
+    foreach ($line in $output) {
+        if ($line -match '^Engine: (\S+) \(') { $engine = $Matches[1] }
+    }
+
+    if ($result -eq $test.Expected -and $engine -eq $test.Engine) {
+        Write-Host -ForegroundColor Green "  [PASS] $($test.ArgList -join ' ') '$($test.Pattern)' vs '$($test.String)' (Expected: $($test.Expected), $($test.Engine))"
+        $passCount++
+    } else {
+        Write-Host -ForegroundColor Red "  [FAIL] $($test.ArgList -join ' ') '$($test.Pattern)' vs '$($test.String)' (Expected: $($test.Expected), $($test.Engine), Got: $result, $engine)"
+        $failCount++
+    }
+}
+
+# --- Run Keyword List Tests ---
+Write-Host ""
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host "  RUNNING AHO-CORASICK KEYWORD LISTS" -ForegroundColor Cyan
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host ""
+
+foreach ($test in $keywordTestCases) {
+    $argsToRun = $test.ArgList + $keywordPattern + $test.String
+    $output = & $executable $argsToRun
+    $result = if ($LASTEXITCODE -eq 0) { "Match" } else { "NoMatch" }
+    $span = ""
+    $usedTrie = $false
+    foreach ($line in $output) {
+        if ($line -match '^Match span: (\[\d+, \d+\))') { $span = $Matches[1] }
+        if ($line -match 'Aho-Corasick Construction') { $usedTrie = $true }
+    }
+
+    if ($result -eq $test.Expected -and $span -eq $test.Span -and $usedTrie) {
+        Write-Host -ForegroundColor Green "  [PASS] $($test.ArgList -join ' ') 2000 keywords vs '$($test.String)' (Expected: $($test.Expected) $($test.Span))"
+        $passCount++
+    } else {
+        Write-Host -ForegroundColor Red "  [FAIL] $($test.ArgList -join ' ') 2000 keywords vs '$($test.String)' (Expected: $($test.Expected) $($test.Span), Got: $result $span)"
+        $failCount++
+    }
+}
+
+# --- Run Lexer Tests ---
+Write-Host ""
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host "  RUNNING LEXER" -ForegroundColor Cyan
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host ""
+
+foreach ($test in $lexerTestCases) {
+    $output = & $executable "--lex" $test.File
+    $result = if ($LASTEXITCODE -eq 0) { "Match" } else { "NoMatch" }
+    $tokens = ""
+    foreach ($line in $output) {
+        if ($line -match '^Tokens: (\d+)') { $tokens = $Matches[1] }
+    }
+
+    if ($result -eq $test.Expected -and $tokens -eq $test.Tokens) {
+        Write-Host -ForegroundColor Green "  [PASS] '$($test.File)' (Expected: $($test.Expected), $($test.Tokens) tokens)"
+        $passCount++
+    } else {
+        Write-Host -ForegroundColor Red "  [FAIL] '$($test.File)' (Expected: $($test.Expected), $($test.Tokens) tokens, Got: $result, $tokens tokens)"
+        $failCount++
+    }
+}
+
+# --- Run Grep Tests ---
+Write-Host ""
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host "  RUNNING MULTI-FILE GREP" -ForegroundColor Cyan
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host ""
+
+foreach ($test in $grepTestCases) {
+    $output = @(& $executable "--grep" "--threads" "2" $test.Pattern $test.Path 2> $null)
+    $result = if ($LASTEXITCODE -eq 0) { "Match" } else { "NoMatch" }
+    $lines = "$($output.Count)"
+    $last = if ($output.Count -gt 0) { $output[-1] } else { "" }
+
+    if ($result -eq $test.Expected -and $lines -eq $test.Lines -and $last.EndsWith($test.Last)) {
+        Write-Host -ForegroundColor Green "  [PASS] '$($test.Pattern)' in '$($test.Path)' (Expected: $($test.Expected), $($test.Lines) lines)"
+        $passCount++
+    } else {
+        Write-Host -ForegroundColor Red "  [FAIL] '$($test.Pattern)' in '$($test.Path)' (Expected: $($test.Expected), $($test.Lines) lines, Got: $result, $lines lines)"
+        $failCount++
+    }
+}
+
+# --- Run Trigram Index Tests ---
+Write-Host ""
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host "  RUNNING TRIGRAM INDEX SEARCH" -ForegroundColor Cyan
+Write-Host "==========================================" -ForegroundColor Cyan
+Write-Host ""
+
+$indexFile = "samples\logs.idx"
+& $executable "--index" $indexFile "samples\logs" > $null
+
+foreach ($test in $indexTestCases) {
+    $errors = ""
+    $output = @(& $executable "--indexed-grep" $indexFile $test.Pattern 2>&1 | ForEach-Object {
+        if ($_ -is [System.Management.Automation.ErrorRecord]) { $errors += "$_`n" } else { $_ }
+    })
+    $result = if ($LASTEXITCODE -eq 0) { "Match" } else { "NoMatch" }
+    $lines = "$($output.Count)"
+    $candidates = ""
+    if ($errors -match 'Candidate blocks: (\d+)') { $candidates = $Matches[1] }
+
+    if ($result -eq $test.Expected -and $lines -eq $test.Lines -and $candidates -eq $test.Candidates) {
+        Write-Host -ForegroundColor Green "  [PASS] '$($test.Pattern)' (Expected: $($test.Expected), $($test.Lines) lines, $($test.Candidates) blocks)"
+        $passCount++
+    } else {
+        Write-Host -ForegroundColor Red "  [FAIL] '$($test.Pattern)' (Expected: $($test.Expected), $($test.Lines) lines, $($test.Candidates) blocks, Got: $result, $lines lines, $candidates blocks)"
+        $failCount++
+    }
+}
+
+Remove-Item $indexFile -ErrorAction SilentlyContinue
+
 # --- Summary ---
-$totalTestsRun = $testCases.Count * $modes.Count
+$totalTestsRun = $testCases.Count * $modes.Count + $productTestCases.Count + $searchTestCases.Count + $plannerTestCases.Count + $keywordTestCases.Count + $lexerTestCases.Count + $grepTestCases.Count + $indexTestCases.Count
 
 Write-Host ""
 Write-Host "---------------------------------"